@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Арена: линейный (bump) распределитель памяти блоками.
+// Объекты в арене не освобождаются по одному — вся память отдаётся
+// разом при уничтожении арены, поэтому хранить в ней можно только
+// тривиально разрушаемые типы (деструкторы не вызываются).
+class Arena {
+public:
+    explicit Arena(std::size_t blockSize = 64 * 1024);
+    ~Arena();
+
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Сырой участок памяти с заданным выравниванием
+    void* allocate(std::size_t size, std::size_t align);
+
+    // Создание объекта в арене
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "В арене хранятся только тривиально разрушаемые типы");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Массив из count объектов, инициализированных по умолчанию ({} / nullptr / 0)
+    template <typename T>
+    T* allocateArray(std::size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "В арене хранятся только тривиально разрушаемые типы");
+        if (count == 0) return nullptr;
+        T* items = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (std::size_t i = 0; i < count; ++i) {
+            new (items + i) T();
+        }
+        return items;
+    }
+
+    // Копия строки в арене
+    std::string_view copyString(std::string_view text);
+
+    // Забирает все блоки другой арены (она становится пустой);
+    // объекты из other остаются на своих местах и живут, пока жива эта арена
+    void merge(Arena& other);
+
+    // Сколько байт выдано из арены
+    std::size_t bytesUsed() const { return bytesUsed_; }
+
+private:
+    struct alignas(std::max_align_t) Block {
+        Block* next;
+        std::size_t size;
+    };
+
+    void addBlock(std::size_t minSize);
+    void release();
+
+    std::size_t blockSize_;
+    Block* head_ = nullptr; // текущий блок, за ним — ранее заполненные
+    char* cur_ = nullptr;
+    char* end_ = nullptr;
+    std::size_t bytesUsed_ = 0;
+};
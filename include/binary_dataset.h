@@ -0,0 +1,31 @@
+#pragma once
+
+#include "encoded_dataset.h"
+
+#include <string>
+
+// Бинарный формат закодированной выборки для быстрой повторной загрузки.
+//
+// Раскладка (порядок байт — как у машины, которая писала файл):
+//   заголовок: "S13D", версия, число строк, число атрибутов;
+//   имена атрибутов, словари атрибутов и словарь классов
+//   (каждая строка — uint32 длина + байты);
+//   затем, с выравниванием на 64 байта, столбцы кодов атрибутов
+//   (numRows значений uint16 подряд) и столбец кодов классов.
+//
+// Загрузка отображает файл в память: столбцы не копируются, buildID3
+// работает прямо с отображёнными страницами. При открытии читаются только
+// заголовок и словари и проверяются границы разделов, так что время
+// открытия не зависит от числа строк, а обрезанный файл отвергается сразу.
+// Коды в столбцах по умолчанию не просматриваются (это затронуло бы каждую
+// страницу файла); для файла из ненадёжного источника validateCodes
+// включает один проход по столбцам: код атрибута — из словаря атрибута
+// или пропуск, код класса — из словаря классов.
+
+// Сохранение закодированной выборки в бинарный файл (только
+// категориальные атрибуты)
+bool saveDatasetBinary(const std::string& filename, const EncodedDataset& data);
+
+// Загрузка выборки из бинарного файла через отображение в память
+bool loadDatasetBinary(const std::string& filename, EncodedDataset& out,
+                       bool validateCodes = false);
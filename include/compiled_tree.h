@@ -0,0 +1,148 @@
+#pragma once
+
+#include "encoded_dataset.h"
+#include "id3.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Узел «скомпилированного» дерева для быстрого вывода (12 байт)
+struct FlatNode {
+    std::int32_t attr = -1;     // индекс атрибута; -1 — лист
+    std::uint32_t offset = 0;   // внутренний узел: начало таблицы детей в childTable;
+                                // лист: код класса (kNoClass — лист без класса)
+    std::uint32_t numCodes = 0; // размер таблицы детей; коды >= numCodes — нет ветки
+};
+
+// Лист без класса (обучающих примеров не было)
+constexpr std::uint32_t kNoClass = 0xFFFFFFFFu;
+
+// numCodes узла с порогом по числовому атрибуту: две ветки в childTable
+// (<= порога и больше), порог — в отдельном массиве по индексу узла
+constexpr std::uint32_t kThresholdNode = 0xFFFFFFFFu;
+
+// Спуск по плоскому дереву от корня nodes[0]; getCode(attr) — код значения
+// атрибута, getNumber(attr) — значение числового атрибута (NaN — пропуск),
+// thresholds — пороги узлов (нужны, только если такие узлы есть).
+// Возвращает индекс листа или -1, если значения нет в дереве
+template <typename GetCode, typename GetNumber>
+inline std::int32_t findFlatLeaf(const FlatNode* nodes,
+                                 const std::int32_t* childTable,
+                                 const double* thresholds,
+                                 GetCode getCode,
+                                 GetNumber getNumber) {
+    std::int32_t index = 0;
+    while (nodes[index].attr >= 0) {
+        const FlatNode& node = nodes[index];
+        if (node.numCodes == kThresholdNode) {
+            const double value = getNumber(node.attr);
+            if (std::isnan(value)) return -1;
+            index = childTable[node.offset + (value > thresholds[index])];
+        } else {
+            const Code value = getCode(node.attr);
+            if (value >= node.numCodes) return -1;
+            index = childTable[node.offset + value];
+        }
+        if (index < 0) return -1;
+    }
+    return index;
+}
+
+// То же, но результат — код класса листа или -1.
+// Общий для CompiledTree и модели, отображённой из файла
+template <typename GetCode, typename GetNumber>
+inline int traverseFlatTree(const FlatNode* nodes,
+                            const std::int32_t* childTable,
+                            const double* thresholds,
+                            GetCode getCode,
+                            GetNumber getNumber) {
+    const std::int32_t leaf = findFlatLeaf(nodes, childTable, thresholds, getCode, getNumber);
+    if (leaf < 0 || nodes[leaf].offset == kNoClass) return -1;
+    return static_cast<int>(nodes[leaf].offset);
+}
+
+// То же для дерева только с категориальными атрибутами
+template <typename GetCode>
+inline int traverseFlatTree(const FlatNode* nodes,
+                            const std::int32_t* childTable,
+                            GetCode getCode) {
+    return traverseFlatTree(nodes, childTable, nullptr, getCode,
+                            [](int) { return std::numeric_limits<double>::quiet_NaN(); });
+}
+
+// Строк в блоке пакетного спуска по плоскому дереву
+constexpr std::size_t kFlatBlockRows = 256;
+
+// Пакетный спуск блока строк [begin, end) выборки (не больше kFlatBlockRows)
+// по плоскому дереву: весь блок проходит дерево уровень за уровнем, так что
+// узлы верхних уровней и таблицы детей остаются в кэше.
+// leaves[i] — индекс листа строки begin + i или -1, как у findFlatLeaf.
+// Общий для classifyBatch деревьев и счёта моделей бустинга
+void findFlatLeaves(const FlatNode* nodes,
+                    const std::int32_t* childTable,
+                    const double* thresholds,
+                    const EncodedDataset& data,
+                    std::size_t begin, std::size_t end,
+                    std::int32_t* leaves);
+
+// Плоское представление обученного дерева: узлы лежат одним массивом
+// в порядке обхода в ширину (корень — узел 0, верхние уровни рядом
+// в памяти), атрибут хранится индексом, а ребёнок выбирается по коду
+// значения из таблицы смещений — без строк и без поиска.
+// Коды входных строк должны быть получены словарями обучающей выборки.
+struct CompiledTree {
+    std::vector<FlatNode> nodes;
+    std::vector<std::int32_t> childTable; // индекс узла-ребёнка или -1
+    std::vector<std::string> classNames;  // код класса -> метка
+    std::vector<double> thresholds;       // порог узла по его индексу;
+                                          // пусто — числовых узлов нет
+
+    // Код класса для строки кодов row[attr]; -1, если значение
+    // не встречалось в обучении (или лист без данных). Числовые
+    // атрибуты кодами не представимы и считаются неизвестными
+    int predictCode(const Code* row) const {
+        return traverseFlatTree(nodes.data(), childTable.data(), thresholds.data(),
+                                [row](int attr) { return row[attr]; },
+                                [](int) { return std::numeric_limits<double>::quiet_NaN(); });
+    }
+
+    // То же для строки колоночной выборки
+    int predictCode(const EncodedDataset& data, std::size_t row) const {
+        return traverseFlatTree(nodes.data(), childTable.data(), thresholds.data(),
+                                [&data, row](int attr) { return data.code(row, attr); },
+                                [&data, row](int attr) { return data.number(row, attr); });
+    }
+
+    // Индекс листа, в который попадает строка выборки, или -1
+    std::int32_t leafIndex(const EncodedDataset& data, std::size_t row) const {
+        return findFlatLeaf(nodes.data(), childTable.data(), thresholds.data(),
+                            [&data, row](int attr) { return data.code(row, attr); },
+                            [&data, row](int attr) { return data.number(row, attr); });
+    }
+
+    // Метка класса по коду; для -1 — "Неизвестно"
+    const std::string& className(int code) const;
+};
+
+// Компиляция дерева, построенного buildID3
+CompiledTree compileTree(const DecisionTree& tree);
+
+// Классификация примера, закодированного через encodeExample
+std::string classify(const CompiledTree& tree,
+                     const std::vector<Code>& encodedExample);
+
+// Пакетная классификация всех строк batch: out[row] = код класса или -1.
+// Строки обрабатываются блоками, и весь блок спускается по дереву
+// уровень за уровнем, так что узлы верхних уровней и таблицы детей
+// остаются в кэше. При numThreads != 1 блоки делятся между потоками
+// (0 — по числу ядер). batch должен быть закодирован словарями обучающей
+// выборки: encodeDataset(examples, train) или loadEncodedDatasetCSV
+// с CsvLoadOptions::dictionaries = &train
+void classifyBatch(const CompiledTree& tree,
+                   const EncodedDataset& batch,
+                   std::int32_t* out,
+                   unsigned numThreads = 1);
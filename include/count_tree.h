@@ -0,0 +1,130 @@
+#pragma once
+
+#include "encoded_dataset.h"
+#include "id3.h"
+#include "split_criteria.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Общие части деревьев, которые учатся по таблицам частот, а не по
+// строкам выборки (HoeffdingTree, IncrementalID3). Узел такого дерева
+// хранит для каждого доступного атрибута частоты классов по кодам его
+// значений; лучший атрибут выбирается по этим таблицам теми же
+// критериями, что и у деревьев из tree_builder.
+namespace count_tree_detail {
+
+// Частоты классов: индекс — код класса
+using ClassCounts = std::vector<std::uint32_t>;
+
+// ++counts[index] с расширением массива
+inline void increment(ClassCounts& counts, std::size_t index) {
+    if (counts.size() <= index) counts.resize(index + 1, 0);
+    ++counts[index];
+}
+
+// Пример со значением value (kUnknownCode — пропуск) и классом label
+// в таблице одного атрибута: byValue[code][class] и missing[class]
+inline void addToTable(std::vector<ClassCounts>& byValue, ClassCounts& missing,
+                       Code value, Code label) {
+    if (value == kUnknownCode) {
+        increment(missing, label);
+        return;
+    }
+    if (byValue.size() <= value) byValue.resize(value + 1);
+    increment(byValue[value], label);
+}
+
+// Код наиболее частого класса; при равенстве — меньший по алфавиту
+// (как majority class у buildID3). kUnknownCode — частот нет
+Code majorityClass(const ClassCounts& counts, const ValueDictionary& labels);
+
+// В узле не больше одного класса
+bool isPure(const ClassCounts& counts);
+
+// Таблица сопряжённости атрибута по его частотам в узле
+void fillTable(ContingencyTable& table, const std::vector<ClassCounts>& byValue,
+               const ClassCounts& missing, std::size_t numClasses);
+
+// Копия дерева в обычный вид. Node — узел с полями attr (-1 — лист) и
+// children (код значения -> поддерево, unique_ptr); leafClass(node) — код
+// класса листа, numCodes(node) — размер таблицы детей внутреннего узла
+// (не меньше children.size()). fallback(node) — класс внутреннего узла
+// для значений, которых он не видел (kUnknownCode — такого класса нет):
+// пустые ячейки таблицы детей получают лист с этим классом, а листья
+// без класса в поддереве наследуют ближайший класс предка. Ветки — в
+// порядке значений, как у построенных деревьев
+template <typename Node, typename LeafClass, typename NumCodes, typename Fallback>
+DecisionTree snapshotTree(const Node& root,
+                          const std::vector<std::string>& attrNames,
+                          const std::vector<ValueDictionary>& attrDicts,
+                          const ValueDictionary& labels,
+                          LeafClass leafClass,
+                          NumCodes numCodes,
+                          Fallback fallback) {
+    Arena arena;
+
+    auto makeLeaf = [&](Code classCode) {
+        auto* out = arena.create<TreeNode>();
+        out->isLeaf = true;
+        out->classCode = classCode;
+        out->label = classCode == kUnknownCode ? std::string_view("Нет данных")
+                                               : arena.copyString(labels.values[classCode]);
+        return out;
+    };
+
+    auto copy = [&](auto& self, const Node& node, Code inherited) -> TreeNode* {
+        if (node.attr < 0) {
+            const Code classCode = leafClass(node);
+            return makeLeaf(classCode == kUnknownCode ? inherited : classCode);
+        }
+
+        const Code own = fallback(node);
+        const Code answer = own == kUnknownCode ? inherited : own;
+
+        const std::size_t size = numCodes(node);
+        auto* out = arena.create<TreeNode>();
+        out->isLeaf = false;
+        out->attrIndex = node.attr;
+        out->label = arena.copyString(attrNames[node.attr]);
+        out->numCodes = size;
+        out->codeChildren = arena.allocateArray<TreeNode*>(size);
+        for (std::size_t code = 0; code < node.children.size(); ++code) {
+            if (!node.children[code]) continue;
+            out->codeChildren[code] = self(self, *node.children[code], answer);
+        }
+
+        // Значения, которых узел не видел, — в общий лист с классом узла
+        if (answer != kUnknownCode) {
+            TreeNode* unseen = nullptr;
+            for (std::size_t code = 0; code < size; ++code) {
+                if (out->codeChildren[code]) continue;
+                if (!unseen) unseen = makeLeaf(answer);
+                out->codeChildren[code] = unseen;
+            }
+        }
+
+        for (std::size_t code = 0; code < size; ++code) {
+            if (out->codeChildren[code]) ++out->numEdges;
+        }
+        out->edges = arena.allocateArray<TreeEdge>(out->numEdges);
+        std::size_t e = 0;
+        for (std::size_t code = 0; code < size; ++code) {
+            if (!out->codeChildren[code]) continue;
+            out->edges[e++] = {static_cast<Code>(code),
+                               arena.copyString(attrDicts[node.attr].values[code]),
+                               out->codeChildren[code]};
+        }
+        std::sort(out->edges, out->edges + out->numEdges,
+                  [](const TreeEdge& a, const TreeEdge& b) { return a.value < b.value; });
+        return out;
+    };
+
+    const TreeNode* tree = copy(copy, root, kUnknownCode);
+    return DecisionTree(std::move(arena), tree);
+}
+
+} // namespace count_tree_detail
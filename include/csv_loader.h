@@ -0,0 +1,43 @@
+#pragma once
+
+#include "encoded_dataset.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Параметры чтения CSV
+struct CsvLoadOptions {
+    std::size_t chunkSize = 4 << 20; // размер блока чтения из файла, байт
+    bool memoryMap = false;          // отобразить файл в память (mmap) и
+                                     // разбирать поля прямо в нём, без буфера
+    unsigned numThreads = 1;         // != 1 — файл отображается в память и
+                                     // разбирается кусками параллельно (0 — все ядра);
+                                     // chunkSize — минимальный размер куска
+    std::vector<std::string> numericAttributes; // имена числовых столбцов; их значения
+                                                // разбираются в double (не число — пропуск)
+    std::size_t numericBins = 0;     // != 0 — после загрузки числовые столбцы
+                                     // разбиваются на столько корзин
+                                     // (binNumericAttributes)
+    const EncodedDataset* dictionaries = nullptr; // != nullptr — кодировать словарями
+                                     // этой (обучающей) выборки: заголовок должен
+                                     // совпадать с её attrNames, типы атрибутов
+                                     // берутся из неё, незнакомые значения и классы
+                                     // получают kUnknownCode, numericAttributes и
+                                     // numericBins не используются
+};
+
+// Чтение CSV в формате saveDatasetToCSV (разделитель ';', первая строка —
+// заголовок, последний столбец — класс) сразу в закодированную колоночную
+// выборку. Файл читается блоками фиксированного размера (или целиком
+// отображается в память при memoryMap), разделители ищутся по 16 байт
+// за раз, а поля кодируются словарями без создания строки на ячейку,
+// так что размер файла ограничен только памятью под коды.
+// Файл для classifyBatch по обученной модели читается с
+// options.dictionaries = &train: иначе коды строятся заново в порядке
+// появления значений и не совпадают с кодами обучения.
+// Ошибки разбора, в том числе столбец с более чем 65535 различными
+// значениями, выводятся в std::cerr, результат — false.
+bool loadEncodedDatasetCSV(const std::string& filename,
+                           EncodedDataset& out,
+                           const CsvLoadOptions& options = {});
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "encoded_dataset.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Параметры записи CSV
+struct CsvWriteOptions {
+    std::size_t bufferSize = 4 << 20; // размер буфера, байт
+    bool backgroundWrite = false;     // писать заполненные буферы в фоновом потоке
+};
+
+// Буферизованная запись CSV с разделителем ';'.
+// Строки собираются в большом буфере простым копированием байт, а в файл
+// уходят редкими крупными вызовами fwrite. В фоновом режиме буферов два:
+// пока один пишется на диск, второй заполняется.
+class CsvWriter {
+public:
+    explicit CsvWriter(const CsvWriteOptions& options = {});
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    // Открытие файла (папки создаются при необходимости)
+    bool open(const std::string& filename);
+
+    // Очередное поле текущей строки
+    void field(std::string_view value);
+
+    // Конец строки
+    void endRow();
+
+    // Дописывает буферы и закрывает файл; false — была ошибка записи
+    bool close();
+
+private:
+    void append(const char* data, std::size_t size);
+    void flush();
+    void waitPending();
+    void writeBlock(const char* data, std::size_t size);
+    void backgroundLoop();
+
+    CsvWriteOptions options_;
+    std::FILE* file_ = nullptr;
+    std::vector<char> buffer_;  // заполняемый буфер
+    std::size_t used_ = 0;      // занято байт в buffer_
+    bool rowStarted_ = false;
+    bool failed_ = false;
+
+    // Фоновая запись
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<char> pending_; // буфер, переданный фоновому потоку
+    std::size_t pendingSize_ = 0;
+    bool hasPending_ = false;
+    bool stopping_ = false;
+};
+
+// Запись закодированной выборки в CSV (формат saveDatasetToCSV).
+// Значения берутся из словарей и копируются в буфер без форматирования;
+// пропуск и класс вне словаря (kUnknownCode) — пустое поле
+bool saveEncodedDatasetCSV(const std::string& filename,
+                           const EncodedDataset& data,
+                           const CsvWriteOptions& options = {});
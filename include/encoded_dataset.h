@@ -0,0 +1,153 @@
+#pragma once
+
+#include "dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Код значения категориального атрибута (или класса)
+using Code = std::uint16_t;
+
+// Код значения, которого нет в словаре (или пропуска в примере)
+constexpr Code kUnknownCode = 0xFFFF;
+
+// Тип атрибута. Значения числовых атрибутов в Example записываются
+// текстом ("12.5") и при кодировании разбираются в double
+enum class AttributeType : std::uint8_t {
+    Categorical,
+    Numeric
+};
+
+// Значение числового атрибута из текста; NaN — пусто или не число
+double parseNumber(std::string_view text);
+
+// Номер корзины пропущенного значения числового атрибута
+constexpr std::uint8_t kMissingBin = 0xFF;
+
+// Наибольшее число корзин одного числового атрибута (без корзины пропусков)
+constexpr std::size_t kMaxBins = 255;
+
+// Словарь значений одного столбца: строка <-> небольшой целый код.
+// Коды выдаются подряд в порядке первого появления значения.
+// Поиск идёт по string_view через собственную хеш-таблицу с открытой
+// адресацией, которая хранит только коды, — при разборе файлов строка
+// создаётся лишь для нового значения, а не для каждой ячейки.
+struct ValueDictionary {
+    std::vector<std::string> values; // код -> значение (пополняется только через encode)
+
+    // Код значения; новое значение добавляется в словарь
+    Code encode(std::string_view value);
+
+    // Код значения или kUnknownCode, если такого значения нет
+    Code find(std::string_view value) const;
+
+    std::size_t size() const { return values.size(); }
+
+private:
+    void rehash(std::size_t capacity);
+
+    std::vector<Code> slots_; // ячейки хеш-таблицы: код или kUnknownCode
+};
+
+class MappedFile;
+
+// Закодированная выборка в колоночном виде: у каждого атрибута свой
+// словарь и свой непрерывный массив кодов (2 байта на ячейку), плюс
+// отдельный массив кодов классов. Оценка одного атрибута читает только
+// его столбец и столбец меток.
+// Коды лежат либо в собственных векторах columns/labels (их заполняют
+// загрузчики), либо прямо в отображённом бинарном файле (mapping) —
+// читать их следует через column()/labelCodes()/code()/label().
+// Числовые атрибуты хранятся отдельными столбцами double (numbers),
+// их столбцы кодов и словари пусты.
+struct EncodedDataset {
+    std::vector<std::string> attrNames;
+    std::vector<ValueDictionary> attrDicts; // словарь для каждого атрибута
+    ValueDictionary labelDict;              // словарь классов
+    std::size_t numRows = 0;
+    std::vector<std::vector<Code>> columns; // столбец кодов для каждого атрибута
+    std::vector<Code> labels;               // код класса каждой строки
+
+    std::vector<AttributeType> attrTypes;     // пусто — все атрибуты категориальные
+    std::vector<std::vector<double>> numbers; // значения числовых атрибутов (NaN — пропуск)
+
+    // Числовые атрибуты, разбитые на корзины (binNumericAttributes):
+    // номер корзины каждой строки (kMissingBin — пропуск) и верхние
+    // границы корзин — корзина b содержит значения <= binEdges[b]
+    std::vector<std::vector<std::uint8_t>> bins;
+    std::vector<std::vector<double>> binEdges;
+
+    // Выборка из бинарного файла: коды не копируются, а читаются из отображения
+    std::shared_ptr<const MappedFile> mapping;
+    std::vector<const Code*> mappedColumns;
+    const Code* mappedLabels = nullptr;
+
+    std::size_t numAttrs() const { return attrNames.size(); }
+
+    const Code* column(int attr) const {
+        return mapping ? mappedColumns[attr] : columns[attr].data();
+    }
+
+    const Code* labelCodes() const {
+        return mapping ? mappedLabels : labels.data();
+    }
+
+    Code code(std::size_t row, int attr) const { return column(attr)[row]; }
+
+    Code label(std::size_t row) const { return labelCodes()[row]; }
+
+    bool isNumeric(int attr) const {
+        return !attrTypes.empty() && attrTypes[attr] == AttributeType::Numeric;
+    }
+
+    bool hasNumericAttributes() const {
+        for (std::size_t a = 0; a < attrTypes.size(); ++a) {
+            if (attrTypes[a] == AttributeType::Numeric) return true;
+        }
+        return false;
+    }
+
+    const double* numberColumn(int attr) const { return numbers[attr].data(); }
+
+    double number(std::size_t row, int attr) const { return numbers[attr][row]; }
+
+    bool isBinned(int attr) const {
+        return static_cast<std::size_t>(attr) < binEdges.size() && !binEdges[attr].empty();
+    }
+
+    const std::uint8_t* binColumn(int attr) const { return bins[attr].data(); }
+};
+
+// Кодирование обычной выборки (словари строятся по ходу).
+// attrTypes задаёт типы атрибутов; пусто — все категориальные
+EncodedDataset encodeDataset(const std::vector<Example>& data,
+                             const std::vector<std::string>& attrNames,
+                             const std::vector<AttributeType>& attrTypes = {});
+
+// Кодирование новых примеров словарями обучающей выборки reference
+// (для классификации обученной моделью и проверочных выборок): атрибуты
+// и их типы — как в reference, незнакомые значения и классы получают
+// kUnknownCode, словари результата — копии словарей reference
+EncodedDataset encodeDataset(const std::vector<Example>& data,
+                             const EncodedDataset& reference);
+
+// Разбиение каждого числового атрибута на не более чем maxBins
+// (<= kMaxBins) корзин по квантилям: в корзины попадает примерно поровну
+// строк, а равные значения не разделяются. Если различных значений не
+// больше maxBins, у каждого своя корзина и деревья строятся так же, как
+// точным поиском порога. Границы корзин — середины между соседними
+// значениями, и пороги узлов берутся из них. После разбиения построители
+// ищут пороги по гистограммам корзин, а не по отсортированным строкам
+void binNumericAttributes(EncodedDataset& data, std::size_t maxBins = kMaxBins);
+
+// Кодирование нового примера словарями уже закодированной выборки;
+// незнакомые значения получают kUnknownCode. Числовые атрибуты кодами
+// не представимы и тоже получают kUnknownCode — для деревьев с ними
+// примеры классифицируются по строкам или по EncodedDataset
+std::vector<Code> encodeExample(const EncodedDataset& dataset,
+                                const Example& example);
+
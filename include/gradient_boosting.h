@@ -0,0 +1,96 @@
+#pragma once
+
+#include "compiled_tree.h"
+#include "encoded_dataset.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Параметры градиентного бустинга
+struct BoostingOptions {
+    std::size_t numRounds = 100;
+    double learningRate = 0.1;          // сжатие вклада каждого дерева
+    std::size_t maxDepth = 4;           // глубина деревьев (листьев не больше 2^maxDepth)
+    std::size_t minRowsPerLeaf = 20;
+    double minChildHessian = 1e-3;      // наименьшая сумма гессианов в листе
+    double l2Regularization = 1.0;      // штраф на значения листьев
+    double rowSampleRate = 1.0;         // доля строк для каждого дерева
+    double columnSampleRate = 1.0;      // доля атрибутов для каждого раунда
+    std::size_t earlyStoppingRounds = 0; // != 0 — остановка, если потери на
+                                         // проверочной выборке не падают столько раундов
+    std::uint64_t seed = 1;
+    unsigned numThreads = 1;            // 0 — все ядра
+};
+
+// Регрессионное дерево бустинга в плоском виде (как CompiledTree):
+// внутренние узлы — те же FlatNode, а лист хранит в offset индекс своего
+// значения в leafValues
+struct RegressionTree {
+    std::vector<FlatNode> nodes;
+    std::vector<std::int32_t> childTable;
+    std::vector<double> thresholds;     // порог узла по его индексу (пусто — нет)
+    std::vector<double> leafValues;
+
+    // Вклад дерева в счёт строки; 0, если значение строки в узле
+    // неизвестно (пропуск или значение, которого не было в обучении)
+    double predict(const EncodedDataset& data, std::size_t row) const {
+        const std::int32_t leaf =
+            findFlatLeaf(nodes.data(), childTable.data(), thresholds.data(),
+                         [&data, row](int attr) { return data.code(row, attr); },
+                         [&data, row](int attr) { return data.number(row, attr); });
+        return leaf < 0 ? 0.0 : leafValues[nodes[leaf].offset];
+    }
+};
+
+// Модель бустинга. Два класса — одна логистическая модель (счёт —
+// логарифм шансов класса с кодом 1), больше — softmax с деревом на
+// каждый класс в каждом раунде
+struct BoostedModel {
+    std::size_t numOutputs = 0;           // 1 — логистическая модель, иначе число классов
+    std::vector<double> baseScores;       // начальный счёт каждого выхода
+    std::vector<RegressionTree> trees;    // раунд r, выход k — trees[r * numOutputs + k]
+    std::vector<std::string> classNames;  // код класса -> метка (словарь обучающей выборки)
+    std::vector<double> validationLoss;   // потери на проверочной выборке по раундам
+
+    std::size_t numRounds() const { return numOutputs ? trees.size() / numOutputs : 0; }
+};
+
+// Обучение бустинга на закодированной выборке. Числовые атрибуты должны
+// быть разбиты на корзины (binNumericAttributes): деревья растут по
+// гистограммам градиентов и гессианов, у дочерних узлов гистограмма
+// меньшего строится проходом, большего — вычитанием из родителя.
+// validation — проверочная выборка, закодированная словарями train:
+// encodeDataset(examples, train) или загрузчик с
+// CsvLoadOptions::dictionaries = &train (для ранней остановки; модель
+// обрезается до лучшего раунда). Строки с классом, которого нет в train,
+// в потерях не учитываются.
+// Возвращает false (с сообщением), если обучать не на чем, у строки train
+// класс вне словаря (kUnknownCode) или словари проверочной выборки не
+// совпадают с обучающими
+bool trainGradientBoosting(const EncodedDataset& train,
+                           const std::vector<int>& availableAttributes,
+                           const BoostingOptions& options,
+                           BoostedModel& model,
+                           const EncodedDataset* validation = nullptr);
+
+// Вероятности классов для строки выборки
+std::vector<double> classProbabilities(const BoostedModel& model,
+                                       const EncodedDataset& data,
+                                       std::size_t row);
+
+// Классификация строки выборки — класс с наибольшей вероятностью
+std::string classify(const BoostedModel& model,
+                     const EncodedDataset& data,
+                     std::size_t row);
+
+// Пакетная классификация: out[row] = код класса. Строки идут блоками,
+// каждое дерево спускает весь блок уровень за уровнем (findFlatLeaves,
+// как classifyBatch для CompiledTree); при numThreads != 1 блоки
+// делятся между потоками. Коды batch — словарями обучающей выборки,
+// как у classifyBatch для CompiledTree
+void classifyBatch(const BoostedModel& model,
+                   const EncodedDataset& batch,
+                   std::int32_t* out,
+                   unsigned numThreads = 1);
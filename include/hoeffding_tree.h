@@ -0,0 +1,75 @@
+#pragma once
+
+#include "dataset.h"
+#include "encoded_dataset.h"
+#include "id3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Параметры потокового дерева
+struct HoeffdingOptions {
+    double delta = 1e-7;          // допустимая вероятность выбрать не лучший атрибут
+    double tieThreshold = 0.05;   // при границе Хёфдинга меньше этого почти равные
+                                  // атрибуты считаются равноценными и лист делится
+    std::size_t gracePeriod = 200; // примеров в листе между попытками разбиения
+};
+
+// Потоковое дерево решений (VFDT, дерево Хёфдинга). Примеры подаются по
+// одному или пачками и сразу забываются: лист хранит только таблицы
+// частот «значение атрибута x класс» (память листа не зависит от числа
+// примеров). Каждые gracePeriod примеров лист сравнивает прирост
+// информации атрибутов и делится, когда граница Хёфдинга гарантирует,
+// что лучший атрибут с вероятностью 1 - delta останется лучшим и на
+// всём потоке. Как в ID3, атрибуты категориальные и на пути не повторяются.
+// Классифицировать можно в любой момент между вызовами learn.
+class HoeffdingTree {
+public:
+    explicit HoeffdingTree(std::vector<std::string> attrNames,
+                           const HoeffdingOptions& options = {});
+    ~HoeffdingTree();
+
+    HoeffdingTree(HoeffdingTree&&) noexcept;
+    HoeffdingTree& operator=(HoeffdingTree&&) noexcept;
+
+    // Обучение на одном примере и на пачке
+    void learn(const Example& example);
+    void learn(const std::vector<Example>& batch);
+
+    // Класс примера: majority class листа, куда он попадает. Значение,
+    // которого узел ещё не видел, — majority class этого узла
+    std::string predict(const Example& example) const;
+
+    std::size_t examplesSeen() const { return examplesSeen_; }
+    std::size_t numNodes() const { return numNodes_; }
+    std::size_t numLeaves() const { return numLeaves_; }
+
+    // Текущее дерево в обычном виде (для printTree, compileTree и т. п.).
+    // Значения, которых узел ещё не видел, ведут в лист с классом узла, а
+    // листья без примеров получают класс предка — как в predict. Отличие
+    // остаётся для значений, которых нет в словарях дерева вовсе, и для
+    // пропусков: classify по снимку отвечает "Неизвестно", predict —
+    // классом узла
+    DecisionTree snapshot() const;
+
+private:
+    struct Node;
+
+    static std::unique_ptr<Node> makeLeaf(std::vector<int> available);
+    void trySplit(Node& leaf);
+
+    std::vector<std::string> attrNames_;
+    HoeffdingOptions options_;
+    std::vector<ValueDictionary> attrDicts_;
+    ValueDictionary labelDict_;
+    std::unique_ptr<Node> root_;
+    std::size_t examplesSeen_ = 0;
+    std::size_t numNodes_ = 1;
+    std::size_t numLeaves_ = 1;
+};
+
+// Классификация примера текущим деревом
+std::string classify(const HoeffdingTree& tree, const Example& example);
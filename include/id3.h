@@ -1,27 +1,151 @@
 #pragma once
 
+#include "arena.h"
 #include "dataset.h"
+#include "encoded_dataset.h"
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// Узел дерева решений
+struct TreeNode;
+
+// Ветка дерева: значение атрибута -> поддерево.
+// У нескольких веток одного узла может быть общее поддерево (CART)
+struct TreeEdge {
+    Code code = kUnknownCode;   // код значения в словаре обучающей выборки
+    std::string_view value;     // значение атрибута
+    TreeNode* child = nullptr;
+};
+
+// Узел дерева решений. Узлы, ветки и строки одного дерева лежат в арене
+// DecisionTree, поэтому узел ничего не владеет и не требует освобождения.
 struct TreeNode {
-    bool isLeaf = false;                       // true, если лист
-    std::string label;                         // если лист — класс; если нет — имя атрибута
-    std::map<std::string, TreeNode*> children; // значение атрибута -> поддерево
+    bool isLeaf = false;          // true, если лист
+    std::string_view label;       // если лист — класс; если нет — имя атрибута
+    Code classCode = kUnknownCode; // код класса листа в словаре обучающей выборки
+
+    int attrIndex = -1;           // индекс атрибута во внутреннем узле
+    TreeEdge* edges = nullptr;    // ветки, упорядоченные по значению атрибута
+    std::size_t numEdges = 0;
+    TreeNode** codeChildren = nullptr; // код значения -> поддерево (nullptr — нет ветки)
+    std::size_t numCodes = 0;
+
+    // Узел по числовому атрибуту: codeChildren[0] — значения <= threshold,
+    // codeChildren[1] — большие; ветки edges подписаны "<= t" и "> t"
+    bool numeric = false;
+    double threshold = 0.0;
+
+    // Поддерево для значения атрибута или nullptr
+    const TreeNode* child(std::string_view value) const;
+};
+
+// Дерево решений вместе с памятью всех его узлов.
+// Уничтожение дерева освобождает несколько блоков арены целиком,
+// без обхода узлов.
+class DecisionTree {
+public:
+    DecisionTree() = default;
+    DecisionTree(Arena arena, const TreeNode* root)
+        : arena_(std::move(arena)), root_(root) {}
+
+    DecisionTree(DecisionTree&&) = default;
+    DecisionTree& operator=(DecisionTree&&) = default;
+
+    const TreeNode* root() const { return root_; }
+
+    // Сколько байт занимают узлы, ветки и строки дерева
+    std::size_t bytesUsed() const { return arena_.bytesUsed(); }
+
+private:
+    Arena arena_;
+    const TreeNode* root_ = nullptr;
 };
 
 // Построение дерева ID3
-TreeNode* buildID3(const std::vector<Example>& data,
-                   const std::vector<std::string>& attrNames,
-                   const std::vector<int>& availableAttributes);
+DecisionTree buildID3(const std::vector<Example>& data,
+                      const std::vector<std::string>& attrNames,
+                      const std::vector<int>& availableAttributes);
+
+// Параметры построения дерева (общие для всех критериев; дерево
+// с собственным критерием строит buildTree из tree_builder.h)
+struct TreeOptions {
+    unsigned numThreads = 1;                     // 1 — последовательно, 0 — все ядра
+    std::size_t parallelScoringMinRows = 50000;  // в узлах меньше этого атрибуты
+                                                 // оцениваются последовательно
+    std::size_t parallelSubtreeMinRows = 10000;  // поддеревья меньше этого строятся
+                                                 // в той же задаче, что и родитель
+    std::size_t attributesPerNode = 0;           // != 0 — в каждом узле оцениваются
+                                                 // столько случайных атрибутов
+                                                 // (случайный лес), 0 — все
+    std::uint64_t seed = 0;                      // зерно выбора атрибутов узлов
+};
+
+// Построение дерева ID3 по закодированной выборке.
+// При numThreads != 1 атрибуты узла оцениваются параллельно, а крупные
+// поддеревья строятся отдельными задачами пула с перехватом работы.
+// При равных выигрышах выбирается атрибут, стоящий раньше в
+// availableAttributes, поэтому дерево совпадает с последовательным построением
+DecisionTree buildID3(const EncodedDataset& data,
+                      const std::vector<int>& availableAttributes,
+                      const TreeOptions& options = {});
+
+// Построение дерева C4.5: атрибут выбирается по отношению выигрыша
+// (gainRatio), что не даёт многозначным атрибутам выигрывать только за
+// счёт числа значений. Узел становится листом, если лучшее отношение
+// выигрыша не больше 1e-9, — как в choose_best_attribute
+// из py/plot_id3_tree.py. Параметры и детерминизм — как у buildID3
+DecisionTree buildC45(const EncodedDataset& data,
+                      const std::vector<int>& availableAttributes,
+                      const TreeOptions& options = {});
+
+DecisionTree buildC45(const std::vector<Example>& data,
+                      const std::vector<std::string>& attrNames,
+                      const std::vector<int>& availableAttributes);
+
+// Построение двоичного дерева CART: значения атрибута делятся на две
+// группы с наибольшим уменьшением индекса Gini (bestBinaryGiniSplit).
+// Значения одной группы — отдельные ветки edges с общим поддеревом
+// child, так что classify и compileTree работают без изменений.
+// Атрибут может использоваться повторно ниже по дереву, пока в узле
+// больше одного его значения; узел становится листом, если уменьшение
+// Gini не больше 1e-9
+DecisionTree buildCART(const EncodedDataset& data,
+                       const std::vector<int>& availableAttributes,
+                       const TreeOptions& options = {});
+
+DecisionTree buildCART(const std::vector<Example>& data,
+                       const std::vector<std::string>& attrNames,
+                       const std::vector<int>& availableAttributes);
+
+// Построение дерева CHAID: в каждом узле значения атрибута, классы
+// которых значимо не различаются, объединяются в группы (chaidSplit),
+// и выбирается атрибут с наименьшим p-value χ² после поправки Бонферрони.
+// Узел делится, только если это p-value меньше 0.05. Группы значений
+// представлены так же, как в CART, — ветками с общим поддеревом
+DecisionTree buildCHAID(const EncodedDataset& data,
+                        const std::vector<int>& availableAttributes,
+                        const TreeOptions& options = {});
+
+DecisionTree buildCHAID(const std::vector<Example>& data,
+                        const std::vector<std::string>& attrNames,
+                        const std::vector<int>& availableAttributes);
 
 // Классификация нового примера по готовому дереву
 std::string classify(const TreeNode* root,
                      const Example& example,
                      const std::vector<std::string>& attrNames);
 
-// Освобождение памяти
-void freeTree(TreeNode* root);
+// Классификация строки закодированной выборки. Коды должны быть получены
+// словарями той выборки, по которой строилось дерево, а числовые атрибуты
+// должны стоять на тех же местах
+std::string classify(const TreeNode* root,
+                     const EncodedDataset& data,
+                     std::size_t row);
+
+// Классификация примера, закодированного через encodeExample
+// (значения числовых атрибутов в нём считаются неизвестными)
+std::string classify(const TreeNode* root,
+                     const std::vector<Code>& encodedExample);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "dataset.h"
+#include "encoded_dataset.h"
+#include "id3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Дерево ID3, которое дообучается пачками новых примеров (в духе ID5R).
+// Каждый внутренний узел хранит таблицы частот «значение атрибута x класс»
+// для всех своих доступных атрибутов, лист — номера своих строк. Новая
+// пачка проходит по дереву, увеличивая счётчики только на своих путях;
+// затем в затронутых узлах лучший атрибут пересчитывается по таблицам
+// (строки для этого не читаются). Заново из строк строятся только
+// поддеревья, где лучший атрибут сменился или лист перестал быть чистым.
+// Результат всегда совпадает с buildID3 на всех полученных примерах
+// (те же словари, те же правила выбора и равенства оценок), а стоимость
+// обновления пропорциональна новым данным и перестроенным поддеревьям.
+class IncrementalID3 {
+public:
+    IncrementalID3(std::vector<std::string> attrNames,
+                   std::vector<int> availableAttributes);
+    ~IncrementalID3();
+
+    IncrementalID3(IncrementalID3&&) noexcept;
+    IncrementalID3& operator=(IncrementalID3&&) noexcept;
+
+    // Добавление пачки примеров и обновление дерева
+    void insert(const std::vector<Example>& batch);
+    void insert(const Example& example);
+
+    // Класс примера, как у classify по дереву buildID3
+    std::string predict(const Example& example) const;
+
+    // Текущее дерево в обычном виде; совпадает с buildID3(data(), available)
+    DecisionTree snapshot() const;
+
+    // Все полученные примеры, закодированные как encodeDataset
+    const EncodedDataset& data() const { return data_; }
+
+    // Строк, заново разложенных по поддеревьям при последнем insert
+    std::size_t rebuiltRows() const { return rebuiltRows_; }
+
+private:
+    struct Node;
+
+    std::unique_ptr<Node> build(std::vector<std::size_t> rows,
+                                std::vector<int> available);
+    void fillTables(Node& node, std::size_t row);
+    int bestAttribute(const Node& node) const;
+    void gatherRows(Node& node, std::vector<std::size_t>& rows) const;
+    void refresh(std::unique_ptr<Node>& node);
+
+    EncodedDataset data_;
+    std::vector<int> available_;
+    std::unique_ptr<Node> root_;
+    std::size_t rebuiltRows_ = 0;
+};
+
+// Классификация примера текущим деревом
+std::string classify(const IncrementalID3& tree, const Example& example);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Файл, отображённый в память только для чтения (mmap). На системах без
+// mmap содержимое просто читается в буфер — интерфейс тот же.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Как будет читаться файл — подсказка ядру (madvise)
+    enum class Access {
+        Sequential, // один проход подряд (CSV): агрессивное чтение с опережением
+        Normal,     // повторные проходы по частям файла (бинарная выборка, модель)
+        Random      // обращения вразброс: без чтения с опережением
+    };
+
+    // Открытие и отображение файла; false — файл не удалось открыть
+    bool open(const std::string& filename, Access access);
+    void close();
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool isOpen() const { return isOpen_; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool isOpen_ = false;
+    bool mapped_ = false;       // true — data_ получен через mmap
+    std::vector<char> buffer_;  // содержимое файла, если mmap недоступен
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "compiled_tree.h"
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Бинарный формат обученной модели.
+//
+// Раскладка (порядок байт — как у машины, которая писала файл):
+//   заголовок со смещениями разделов;
+//   массив FlatNode (как в CompiledTree) и таблица детей int32;
+//   строковые таблицы: имена атрибутов, словарь каждого атрибута,
+//   имена классов. Каждая таблица — число строк, смещения строк,
+//   готовая хеш-таблица (код по хешу FNV-1a) и сами байты строк.
+//
+// Модель открывается отображением файла: узлы и словари используются
+// прямо из отображённых страниц, ничего не разбирается и не копируется,
+// кроме указателей на разделы. При открытии узлы и строковые таблицы
+// один раз проверяются (атрибуты, таблицы детей, коды классов, смещения
+// и хеш-ячейки), так что повреждённый файл отвергается сразу, а не
+// приводит к чтению за границами или зацикливанию при классификации.
+
+// Сохранение скомпилированного дерева вместе со словарями обучающей
+// выборки, по которой оно строилось. Деревья с порогами по числовым
+// атрибутам формат не описывает — для них возвращается false
+bool saveModel(const std::string& filename,
+               const CompiledTree& tree,
+               const EncodedDataset& trainingData);
+
+// Модель, отображённая из файла
+class MappedModel {
+public:
+    // Строковая таблица внутри отображённого файла
+    struct StringTable {
+        std::uint32_t count = 0;
+        std::uint32_t numSlots = 0;         // степень двойки
+        const std::uint32_t* offsets = nullptr; // count + 1 смещений в bytes
+        const Code* slots = nullptr;        // хеш-таблица: код или kUnknownCode
+        const char* bytes = nullptr;
+
+        std::string_view at(std::size_t code) const {
+            return {bytes + offsets[code], offsets[code + 1] - offsets[code]};
+        }
+
+        // Код строки или kUnknownCode
+        Code find(std::string_view value) const;
+    };
+
+    bool open(const std::string& filename);
+
+    std::size_t numAttrs() const { return attrNames_.count; }
+    std::size_t numClasses() const { return classNames_.count; }
+    std::string_view attrName(std::size_t attr) const { return attrNames_.at(attr); }
+
+    // Метка класса по коду; для -1 — "Неизвестно"
+    std::string_view className(int code) const;
+
+    // Код значения атрибута по словарю модели
+    Code encodeValue(std::size_t attr, std::string_view value) const {
+        return attrDicts_[attr].find(value);
+    }
+
+    // Код класса для строки кодов row[attr] (коды словарей модели)
+    int predictCode(const Code* row) const {
+        return traverseFlatTree(nodes_, childTable_,
+                                [row](int attr) { return row[attr]; });
+    }
+
+    // Классификация примера со строковыми значениями: значения кодируются
+    // по мере спуска, только для атрибутов на пути
+    std::string_view classify(const Example& example) const;
+
+private:
+    MappedFile file_;
+    const FlatNode* nodes_ = nullptr;
+    const std::int32_t* childTable_ = nullptr;
+    StringTable attrNames_;
+    std::vector<StringTable> attrDicts_;
+    StringTable classNames_;
+};
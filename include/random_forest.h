@@ -0,0 +1,133 @@
+#pragma once
+
+#include "compiled_tree.h"
+#include "encoded_dataset.h"
+#include "thread_pool.h"
+#include "tree_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Параметры случайного леса
+struct ForestOptions {
+    std::size_t numTrees = 100;
+    std::size_t attributesPerNode = 0; // атрибутов на выбор в узле;
+                                       // 0 — корень из числа атрибутов
+    double sampleFraction = 1.0;       // размер бутстреп-выборки в долях выборки
+    std::uint64_t seed = 1;
+    unsigned numThreads = 1;           // деревья строятся параллельно (0 — все ядра)
+};
+
+// Дерево леса: плоское дерево и доли классов обучающих строк в его листьях
+struct ForestTree {
+    CompiledTree tree;
+    std::vector<std::uint32_t> leafSlots; // индекс узла -> строка leafShares
+    std::vector<float> leafShares;        // листья x классы
+};
+
+// Случайный лес: деревья на бутстреп-выборках со случайными атрибутами узлов
+struct RandomForest {
+    std::vector<ForestTree> trees;
+    std::vector<std::string> classNames; // код класса -> метка (словарь обучающей выборки)
+
+    std::size_t numClasses() const { return classNames.size(); }
+};
+
+// Как объединяются ответы деревьев
+enum class ForestVote {
+    Majority,   // класс, за который больше всего деревьев
+    Probability // класс с наибольшей средней долей в листьях деревьев
+};
+
+namespace random_forest_detail {
+
+// Бутстреп-выборка: numRows * fraction случайных строк с возвращением,
+// результат — сколько раз выпала каждая строка
+std::vector<std::uint32_t> bootstrapCounts(std::size_t numRows, double fraction,
+                                           std::uint64_t seed);
+
+// Дерево леса из построенного дерева: доли классов в листьях считаются
+// по той же бутстреп-выборке, на которой дерево обучалось
+ForestTree makeForestTree(const DecisionTree& tree,
+                          const EncodedDataset& data,
+                          const std::vector<std::uint32_t>& rowCounts);
+
+} // namespace random_forest_detail
+
+// Обучение случайного леса с критерием Criterion (по умолчанию — ID3).
+// Каждое дерево строит buildTree по своей бутстреп-выборке: она задаётся
+// кратностями строк, так что выборка не копируется. В узле оцениваются
+// attributesPerNode случайных атрибутов. Деревья строятся независимыми
+// задачами пула, а их зёрна выводятся из seed и номера дерева, поэтому
+// лес не зависит от числа потоков. При sampleFraction <= 0 или не
+// конечном выводится сообщение и возвращается пустой лес
+template <typename Criterion = InformationGainCriterion>
+RandomForest buildRandomForest(const EncodedDataset& data,
+                               const std::vector<int>& availableAttributes,
+                               const ForestOptions& options = {}) {
+    using namespace random_forest_detail;
+
+    RandomForest forest;
+    if (!(options.sampleFraction > 0.0) || !std::isfinite(options.sampleFraction)) {
+        std::cerr << "Доля бутстреп-выборки должна быть положительным числом\n";
+        return forest;
+    }
+    forest.classNames = data.labelDict.values;
+    forest.trees.resize(options.numTrees);
+
+    TreeOptions treeOptions;
+    treeOptions.attributesPerNode =
+        options.attributesPerNode != 0
+            ? options.attributesPerNode
+            : std::max<std::size_t>(
+                  1, static_cast<std::size_t>(std::lround(
+                         std::sqrt(static_cast<double>(availableAttributes.size())))));
+
+    auto buildOne = [&](std::size_t t, unsigned) {
+        const std::uint64_t seed = tree_builder_detail::mixSeed(options.seed, t);
+        const std::vector<std::uint32_t> counts =
+            bootstrapCounts(data.numRows, options.sampleFraction, seed);
+
+        TreeOptions local = treeOptions;
+        local.seed = tree_builder_detail::mixSeed(seed, 0);
+        const DecisionTree tree = buildTree<Criterion>(data, availableAttributes, local, counts);
+        forest.trees[t] = makeForestTree(tree, data, counts);
+    };
+
+    if (options.numThreads == 1) {
+        for (std::size_t t = 0; t < options.numTrees; ++t) buildOne(t, 0);
+    } else {
+        ThreadPool pool(options.numThreads);
+        pool.parallelFor(options.numTrees, buildOne);
+    }
+    return forest;
+}
+
+// Доли классов для строки выборки: среднее по деревьям, дошедшим до листа
+// (нули, если ни одно дерево не знает значений строки)
+std::vector<double> classProbabilities(const RandomForest& forest,
+                                       const EncodedDataset& data,
+                                       std::size_t row);
+
+// Классификация строки выборки; при равенстве голосов — меньшая по
+// алфавиту метка, как у листьев дерева
+std::string classify(const RandomForest& forest,
+                     const EncodedDataset& data,
+                     std::size_t row,
+                     ForestVote vote = ForestVote::Majority);
+
+// Пакетная классификация: out[row] = код класса или -1. Строки идут
+// блоками, и каждое дерево проходит весь блок подряд, пока его верхние
+// уровни в кэше. При numThreads != 1 блоки делятся между потоками.
+// Коды batch — словарями обучающей выборки, как у classifyBatch для
+// CompiledTree
+void classifyBatch(const RandomForest& forest,
+                   const EncodedDataset& batch,
+                   std::int32_t* out,
+                   unsigned numThreads = 1,
+                   ForestVote vote = ForestVote::Majority);
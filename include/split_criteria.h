@@ -0,0 +1,93 @@
+#pragma once
+
+#include "encoded_dataset.h"
+
+#include <cstddef>
+#include <vector>
+
+// Таблица сопряжённости (значение атрибута x класс) для строк одного узла.
+// Строится за один проход и служит источником всех критериев разбиения.
+// Память переиспользуется: повторное заполнение таблицы того же или
+// меньшего размера ничего не выделяет.
+struct ContingencyTable {
+    std::size_t numValues = 0;     // коды атрибута 0..numValues-1
+    std::size_t numClasses = 0;    // коды классов 0..numClasses-1
+    std::vector<int> counts;       // (numValues + 1) x numClasses, последняя
+                                   // строка — примеры с пропущенным значением
+    std::vector<int> valueTotals;  // число примеров по каждому значению
+    std::vector<int> classTotals;  // число примеров по классам (весь узел)
+    int total = 0;                 // всего примеров в узле
+    int known = 0;                 // примеров с известным значением атрибута
+
+    int at(std::size_t value, std::size_t cls) const {
+        return counts[value * numClasses + cls];
+    }
+};
+
+// Заполнение таблицы по строкам rows[0..count) за один проход
+void fillContingencyTable(ContingencyTable& table,
+                          const Code* column,
+                          std::size_t numValues,
+                          const Code* labels,
+                          std::size_t numClasses,
+                          const std::size_t* rows,
+                          std::size_t count);
+
+// Энтропия распределения частот (в битах)
+double entropyOfCounts(const int* freq, std::size_t size, double n);
+
+// Энтропия классов во всём узле
+double parentEntropy(const ContingencyTable& table);
+
+// Условная энтропия классов после разбиения по значениям атрибута
+double conditionalEntropy(const ContingencyTable& table);
+
+// Информационный выигрыш (ID3)
+double informationGain(const ContingencyTable& table);
+
+// SplitInfo — энтропия распределения примеров по значениям атрибута
+double splitInfo(const ContingencyTable& table);
+
+// Отношение выигрыша (C4.5)
+double gainRatio(const ContingencyTable& table);
+
+// Уменьшение индекса Gini при разбиении (CART)
+double giniGain(const ContingencyTable& table);
+
+// Лучшее двоичное разбиение значений атрибута по уменьшению индекса
+// Gini (CART). Для двух классов значения упорядочиваются по доле одного
+// класса и перебираются только разрезы этого порядка — это точный
+// оптимум (теорема Бреймана). Для большего числа классов при малом числе
+// значений перебираются все разбиения, иначе используется тот же порядок
+// по доле самого частого класса узла.
+// В groups (если задан) записывается ветка каждого значения: 0 или 1 для
+// значений, встретившихся в узле, и -1 для остальных.
+// Возвращает уменьшение Gini; 0, если в узле меньше двух значений.
+double bestBinaryGiniSplit(const ContingencyTable& table,
+                           std::vector<int>* groups = nullptr);
+
+// Статистика χ² по таблице сопряжённости (CHAID)
+double chiSquare(const ContingencyTable& table);
+
+// Натуральный логарифм p-value статистики χ² с df степенями свободы
+// (верхний хвост распределения). Считается в логарифмах, поэтому
+// не обращается в -inf для очень значимых таблиц.
+double chiSquareLogPValue(double chi2, double df);
+
+// Разбиение атрибута по CHAID
+struct ChaidSplit {
+    double logPValue = 0.0;   // ln p-value с поправкой Бонферрони (0 — p = 1)
+    std::size_t numGroups = 0; // число групп значений после объединения
+};
+
+// Объединение категорий и оценка атрибута по CHAID (Kass, 1980).
+// Пока есть пара групп значений, распределения классов которых значимо
+// не различаются (наибольшее p-value χ² таблицы 2 x классы больше
+// mergeAlpha), эта пара сливается. Затем считается p-value χ² таблицы
+// групп x классы и умножается на поправку Бонферрони — число способов
+// получить столько групп из исходных значений (число Стирлинга второго
+// рода). В groups (если задан) записывается номер группы каждого значения
+// по порядку первых значений групп, -1 — значения нет в узле.
+// Строки с пропущенным значением не учитываются.
+ChaidSplit chaidSplit(const ContingencyTable& table, double mergeAlpha,
+                      std::vector<int>* groups = nullptr);
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом задач (work stealing) для параллельного обучения.
+// У каждого исполнителя своя очередь: свои задачи он берёт с конца (LIFO,
+// горячие данные в кэше), чужие — перехватывает с начала (самые крупные).
+// Поток, вызвавший пул извне, считается отдельным исполнителем, поэтому
+// всего работает concurrency() = число рабочих потоков + 1.
+// Предполагается один внешний вызывающий поток.
+class ThreadPool {
+public:
+    // Группа задач, завершения которых можно дождаться через wait().
+    // Исключение из задачи запоминается (первое) и выбрасывается из wait()
+    class TaskGroup {
+    public:
+        TaskGroup() = default;
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+
+    private:
+        friend class ThreadPool;
+        std::atomic<std::size_t> pending_{0};
+        std::mutex errorMutex_;
+        std::exception_ptr error_;
+    };
+
+    // numThreads — общее число потоков с учётом вызывающего;
+    // 0 — по числу аппаратных потоков
+    explicit ThreadPool(unsigned numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned concurrency() const {
+        return static_cast<unsigned>(workers_.size()) + 1;
+    }
+
+    // Номер исполнителя, на котором работает текущий поток
+    unsigned currentSlot() const;
+
+    // Кладёт задачу в очередь текущего исполнителя. task(slot) получает
+    // номер исполнителя slot < concurrency(), по нему удобно выбирать
+    // собственный рабочий буфер без синхронизации
+    void run(TaskGroup& group, std::function<void(unsigned)> task);
+
+    // Ждёт завершения всех задач группы, выполняя тем временем
+    // свои и перехваченные задачи (поэтому вложенные ожидания не блокируют пул).
+    // Если брать нечего, поток засыпает до завершения группы или новых задач.
+    // Если задача группы выбросила исключение, wait() дожидается остальных
+    // и выбрасывает его
+    void wait(TaskGroup& group);
+
+    // Выполняет body(index, slot) для index в [0, count) и ждёт завершения;
+    // исключение из body выбрасывается после завершения всех итераций
+    void parallelFor(std::size_t count,
+                     const std::function<void(std::size_t, unsigned)>& body);
+
+private:
+    struct Task {
+        std::function<void(unsigned)> fn;
+        TaskGroup* group = nullptr;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool tryPop(unsigned slot, Task& task);
+    void execute(Task& task, unsigned slot);
+    void workerLoop(unsigned slot);
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_; // по одной на исполнителя
+    std::atomic<std::size_t> queued_{0};             // задач во всех очередях
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;                // простаивающие рабочие потоки
+    std::condition_variable waitCv_;                 // уснувшие в wait()
+    std::atomic<unsigned> parked_{0};                // сколько потоков спит в wait()
+    bool stopping_ = false;
+};
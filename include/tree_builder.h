@@ -0,0 +1,719 @@
+#pragma once
+
+#include "id3.h"
+#include "split_criteria.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Построитель дерева решений, параметризованный критерием разбиения.
+// Критерий — класс только со статическими членами; он подставляется
+// в цикл оценки атрибутов при компиляции, без виртуальных вызовов:
+//
+//   static double score(const ContingencyTable& table);
+//       оценка атрибута по таблице сопряжённости узла (больше — лучше);
+//   static constexpr double minScore;
+//       узел делится, только если лучшая оценка строго больше minScore;
+//   static constexpr bool groupsValues;
+//       false — у каждого значения атрибута своя ветка; true — ветки
+//       задаёт split;
+//   static double split(const ContingencyTable& table, std::vector<int>& groups,
+//                       std::size_t& numGroups);
+//       (только при groupsValues) оценка категориального атрибута вместе
+//       с ветками: номер ветки для каждого кода значения (-1 — значения
+//       нет в узле) и их число. Ветки победителя сохраняются с оценки,
+//       так что при разбиении узла они не считаются повторно;
+//   static constexpr bool reusesAttributes;
+//       true — выбранный категориальный атрибут остаётся доступным
+//       в поддеревьях.
+//
+// Числовой атрибут делится порогом на две ветки; тот же score оценивает
+// каждый порог по таблице 2 x классы, а сам атрибут всегда остаётся
+// доступным в поддеревьях. Пороги атрибута, разбитого на корзины
+// (binNumericAttributes), ищутся по гистограмме корзин узла.
+//
+// Значения по умолчанию даёт SplitCriterion, поэтому новому критерию
+// достаточно унаследовать его и определить score:
+//
+//   struct MyCriterion : SplitCriterion {
+//       static double score(const ContingencyTable& table) { ... }
+//   };
+//   DecisionTree tree = buildTree<MyCriterion>(data, availableAttributes);
+
+// Значения по умолчанию: ветка на каждое значение, атрибут используется
+// один раз, узел делится при любой оценке
+struct SplitCriterion {
+    static constexpr double minScore = -std::numeric_limits<double>::infinity();
+    static constexpr bool groupsValues = false;
+    static constexpr bool reusesAttributes = false;
+};
+
+// ID3: информационный выигрыш
+struct InformationGainCriterion : SplitCriterion {
+    static double score(const ContingencyTable& table) { return informationGain(table); }
+};
+
+// C4.5: отношение выигрыша; нулевое отношение — лист
+struct GainRatioCriterion : SplitCriterion {
+    static constexpr double minScore = 1e-9;
+    static double score(const ContingencyTable& table) { return gainRatio(table); }
+};
+
+// CART: двоичное разбиение значений по индексу Gini. Атрибут можно
+// делить повторно, пока в ветке остаётся больше одного его значения
+struct BinaryGiniCriterion : SplitCriterion {
+    static constexpr double minScore = 1e-9;
+    static constexpr bool groupsValues = true;
+    static constexpr bool reusesAttributes = true;
+    static double score(const ContingencyTable& table) { return bestBinaryGiniSplit(table); }
+    static double split(const ContingencyTable& table, std::vector<int>& groups,
+                        std::size_t& numGroups) {
+        numGroups = 2;
+        return bestBinaryGiniSplit(table, &groups);
+    }
+};
+
+// CHAID: значения объединяются в группы (chaidSplit), выбирается атрибут
+// с наименьшим p-value после поправки Бонферрони. Оценка — -ln p, узел
+// делится, если p < 0.05. Как в CHAID, атрибут может снова делить ветку,
+// в которой осталось несколько его значений
+struct ChaidCriterion : SplitCriterion {
+    static constexpr double mergeAlpha = 0.05;
+    static constexpr double minScore = 2.995732273553991; // -ln 0.05
+    static constexpr bool groupsValues = true;
+    static constexpr bool reusesAttributes = true;
+    static double score(const ContingencyTable& table) {
+        return -chaidSplit(table, mergeAlpha).logPValue;
+    }
+    static double split(const ContingencyTable& table, std::vector<int>& groups,
+                        std::size_t& numGroups) {
+        const ChaidSplit result = chaidSplit(table, mergeAlpha, &groups);
+        numGroups = result.numGroups;
+        return -result.logPValue;
+    }
+};
+
+// Внутренности построителя. Шаблонная часть находится в заголовке, чтобы
+// buildTree можно было инстанцировать с критерием пользователя;
+// нешаблонные функции реализованы в tree_builder.cpp
+namespace tree_builder_detail {
+
+// Полуинтервал [begin, end) в общем массиве индексов строк.
+// Обучение работает с одной неизменяемой выборкой и переставляет только
+// индексы — сами примеры при построении дерева не копируются.
+struct RowRange {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+
+    std::size_t size() const { return end - begin; }
+    bool empty() const { return begin == end; }
+};
+
+// Раскладка диапазона индексов по веткам подсчётом (как в сортировке
+// подсчётом). groupOf(row) — номер ветки строки; numGroups — строка уходит
+// в хвост диапазона. Сначала groupOffsets считает границы веток:
+// offsets[g] — начало ветки g, offsets[numGroups] — начало хвоста; затем
+// scatterRows раскладывает по ним массив индексов, сохраняя порядок строк
+// внутри каждой ветки. Одни и те же границы годятся для любого массива,
+// диапазон которого содержит те же строки.
+template <typename GroupOf>
+std::vector<std::size_t> groupOffsets(const std::vector<std::size_t>& order, RowRange range,
+                                      std::size_t numGroups, GroupOf groupOf) {
+    std::vector<std::size_t> offsets(numGroups + 1, 0);
+    for (std::size_t i = range.begin; i < range.end; ++i) {
+        const std::size_t group = groupOf(order[i]);
+        if (group != numGroups) ++offsets[group + 1];
+    }
+    offsets[0] = range.begin;
+    for (std::size_t g = 0; g < numGroups; ++g) offsets[g + 1] += offsets[g];
+    return offsets;
+}
+
+template <typename GroupOf>
+void scatterRows(std::vector<std::size_t>& order, std::vector<std::size_t>& scratch,
+                 RowRange range, const std::vector<std::size_t>& offsets, GroupOf groupOf) {
+    const std::size_t numGroups = offsets.size() - 1;
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    std::size_t tail = offsets[numGroups];
+    for (std::size_t i = range.begin; i < range.end; ++i) {
+        const std::size_t row = order[i];
+        const std::size_t group = groupOf(row);
+        if (group == numGroups) {
+            scratch[tail++] = row;
+        } else {
+            scratch[next[group]++] = row;
+        }
+    }
+    std::copy(scratch.begin() + range.begin, scratch.begin() + range.end,
+              order.begin() + range.begin);
+}
+
+// Общее состояние рекурсивного построения
+struct BuildContext {
+    BuildContext(const EncodedDataset& data, const TreeOptions& options)
+        : data(data), options(options) {}
+
+    const EncodedDataset& data;
+    const TreeOptions& options;
+    ThreadPool* pool = nullptr;           // nullptr — последовательное построение
+    std::vector<std::size_t> rows;        // индексы строк, переставляются на месте
+    std::vector<std::size_t> scratch;     // буфер для раскладки индексов по значениям
+    std::vector<ContingencyTable> tables; // переиспользуемые таблицы, по одной на поток
+    std::vector<Arena> arenas;            // узлы дерева, по арене на поток
+
+    // Для числовых атрибутов — индексы строк, упорядоченные по значению
+    // (пропуски в конце). Сортировка делается один раз: при разбиении узла
+    // массивы раскладываются по веткам с сохранением порядка, и диапазон
+    // узла в каждом из них содержит те же строки, что и в rows
+    std::vector<std::vector<std::size_t>> sorted;
+    std::vector<std::uint32_t> rowGroup;  // ветка каждой строки разбиваемого узла
+
+    // Гистограммы атрибутов с корзинами: у узла одна плоская таблица, в ней
+    // для каждого такого атрибута блок (корзины + пропуски) x классы
+    std::vector<int> histogramAttrs;
+    std::vector<std::size_t> histogramOffsets; // начало блока по индексу атрибута
+    std::size_t histogramSize = 0;
+
+    // Строки дерева: скопированы в арену один раз, узлы ссылаются на них
+    std::vector<std::string_view> attrNames;
+    std::vector<std::vector<std::string_view>> values;
+    std::vector<std::string_view> labelNames;
+
+    // Арена исполнителя, на котором работает текущий поток
+    Arena& arena() { return arenas[pool ? pool->currentSlot() : 0]; }
+};
+
+// Подсчёт частот классов: индекс — код класса
+std::vector<int> countLabels(const BuildContext& ctx, RowRange range);
+
+// Все примеры узла одного класса
+bool isPure(const std::vector<int>& freq);
+
+// Код наиболее частого класса по частотам классов узла
+Code majorityClass(const BuildContext& ctx, const std::vector<int>& freq);
+
+// Разбиение диапазона по веткам атрибута. groups — номер ветки для
+// каждого кода, пустой groups — у каждого кода своя ветка.
+// Результат: поддиапазон строк для каждой ветки
+std::vector<RowRange> partitionByAttribute(BuildContext& ctx,
+                                           RowRange range,
+                                           int attrIndex,
+                                           const std::vector<int>& groups,
+                                           std::size_t numGroups);
+
+// Разбиение диапазона по порогу числового атрибута: ветка 0 — значения
+// <= threshold, ветка 1 — большие
+std::vector<RowRange> partitionByThreshold(BuildContext& ctx,
+                                           RowRange range,
+                                           int attrIndex,
+                                           double threshold);
+
+// Подпись ветки числового узла ("<= t" или "> t") в арене дерева
+std::string_view thresholdLabel(BuildContext& ctx, bool greater, double threshold);
+
+// Гистограммы корзин по строкам диапазона
+void fillHistograms(BuildContext& ctx, RowRange range, std::vector<int>& histogram);
+
+// Гистограммы детей после разбиения узла. Прямым проходом fill(range, hist)
+// считаются все ветки, кроме самой большой (и хвост строк без ветки), а
+// гистограмма самой большой получается вычитанием: родитель минус
+// остальные — так число просмотренных строк не больше половины узла.
+// Bin — ячейка гистограммы с операцией -= (частота класса у построителя,
+// сумма градиентов у бустинга); из равных по размеру веток вычитанием
+// получается последняя. Пустая гистограмма родителя — пустые у всех детей
+template <typename Bin, typename Fill>
+std::vector<std::vector<Bin>> subtractChildHistograms(RowRange range,
+                                                      const std::vector<RowRange>& parts,
+                                                      std::vector<Bin> histogram,
+                                                      Fill fill) {
+    std::vector<std::vector<Bin>> children(parts.size());
+    if (histogram.empty() || parts.empty()) return children;
+
+    std::size_t largest = 0;
+    for (std::size_t g = 1; g < parts.size(); ++g) {
+        if (parts[g].size() >= parts[largest].size()) largest = g;
+    }
+
+    auto subtract = [&histogram](const std::vector<Bin>& part) {
+        for (std::size_t i = 0; i < histogram.size(); ++i) histogram[i] -= part[i];
+    };
+
+    for (std::size_t g = 0; g < parts.size(); ++g) {
+        if (g == largest || parts[g].empty()) continue;
+        fill(parts[g], children[g]);
+        subtract(children[g]);
+    }
+
+    // Строки без ветки лежат в хвосте диапазона после последней ветки
+    const RowRange tail{parts.back().end, range.end};
+    if (!tail.empty()) {
+        std::vector<Bin> tailHistogram;
+        fill(tail, tailHistogram);
+        subtract(tailHistogram);
+    }
+
+    if (!parts[largest].empty()) children[largest] = std::move(histogram);
+    return children;
+}
+
+// Гистограммы детей для частот классов построителя
+std::vector<std::vector<int>> childHistograms(BuildContext& ctx, RowRange range,
+                                              const std::vector<RowRange>& parts,
+                                              const std::vector<int>& histogram);
+
+// Лист с классом classCode; kUnknownCode — лист без данных
+TreeNode* makeLeaf(BuildContext& ctx, Code classCode);
+
+// Индексы строк, рабочие буферы и строки словарей (копируются в arena);
+// числовые атрибуты из availableAttributes упорядочиваются или получают
+// место в гистограммах. rowCounts — сколько раз строка входит в обучение
+// (пусто — каждая по разу)
+void prepareBuild(BuildContext& ctx, Arena& arena,
+                  const std::vector<int>& availableAttributes,
+                  const std::vector<std::uint32_t>& rowCounts);
+
+// Зерно для потомка: перемешивание зерна родителя с номером ветки
+std::uint64_t mixSeed(std::uint64_t seed, std::uint64_t value);
+
+// count случайных атрибутов из availableAttributes в их исходном порядке
+std::vector<int> sampleAttributes(const std::vector<int>& availableAttributes,
+                                  std::size_t count, std::uint64_t seed);
+
+// Пул потоков для options.numThreads; nullptr — последовательное построение
+std::unique_ptr<ThreadPool> makeBuildPool(const TreeOptions& options);
+
+// Таблица сопряжённости категориального атрибута за один проход по строкам узла
+inline void fillNodeTable(const BuildContext& ctx, ContingencyTable& table,
+                          RowRange range, int attrIndex) {
+    fillContingencyTable(table,
+                         ctx.data.column(attrIndex),
+                         ctx.data.attrDicts[attrIndex].size(),
+                         ctx.data.labelCodes(),
+                         ctx.data.labelDict.size(),
+                         ctx.rows.data() + range.begin,
+                         range.size());
+}
+
+// Оценка атрибута по таблице сопряжённости узла
+template <typename Criterion>
+double attributeScore(const BuildContext& ctx, ContingencyTable& table,
+                      RowRange range, int attrIndex) {
+    fillNodeTable(ctx, table, range, attrIndex);
+    return Criterion::score(table);
+}
+
+// Оценка атрибута вместе с ветками его значений (критерии с groupsValues)
+template <typename Criterion>
+double attributeSplit(const BuildContext& ctx, ContingencyTable& table,
+                      RowRange range, int attrIndex,
+                      std::vector<int>& groups, std::size_t& numGroups) {
+    fillNodeTable(ctx, table, range, attrIndex);
+    return Criterion::split(table, groups, numGroups);
+}
+
+// Лучший порог числового атрибута: линейный проход по строкам узла,
+// заранее упорядоченным по значению. Строки по одной переходят из правой
+// строки таблицы 2 x классы в левую, и на каждой границе между разными
+// значениями порог оценивается критерием. Порог — середина между
+// соседними значениями. Возвращает оценку лучшего порога или -inf,
+// если в узле меньше двух различных значений
+template <typename Criterion>
+double thresholdScore(const BuildContext& ctx, ContingencyTable& table,
+                      RowRange range, int attrIndex, double& threshold) {
+    const std::size_t numClasses = ctx.data.labelDict.size();
+    const double* values = ctx.data.numberColumn(attrIndex);
+    const Code* labels = ctx.data.labelCodes();
+    const std::size_t* order = ctx.sorted[attrIndex].data() + range.begin;
+    const std::size_t count = range.size();
+
+    // Пропуски (NaN) упорядочены в конец и попадают в строку пропусков
+    std::size_t known = count;
+    while (known > 0 && std::isnan(values[order[known - 1]])) --known;
+
+    table.numValues = 2;
+    table.numClasses = numClasses;
+    table.counts.assign(3 * numClasses, 0);
+    table.valueTotals.assign(2, 0);
+    table.classTotals.assign(numClasses, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Code cls = labels[order[i]];
+        ++table.counts[(i < known ? numClasses : 2 * numClasses) + cls];
+        ++table.classTotals[cls];
+    }
+    table.valueTotals[1] = static_cast<int>(known);
+    table.total = static_cast<int>(count);
+    table.known = static_cast<int>(known);
+
+    double best = -std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i + 1 < known; ++i) {
+        const Code cls = labels[order[i]];
+        ++table.counts[cls];
+        --table.counts[numClasses + cls];
+        ++table.valueTotals[0];
+        --table.valueTotals[1];
+
+        const double value = values[order[i]];
+        const double next = values[order[i + 1]];
+        if (!(value < next)) continue;
+
+        const double score = Criterion::score(table);
+        if (score > best) {
+            best = score;
+            threshold = value + (next - value) / 2;
+            if (!(threshold < next)) threshold = value;
+        }
+    }
+    return best;
+}
+
+// Лучший порог атрибута с корзинами: тот же проход, что в thresholdScore,
+// но по гистограмме узла — корзина за корзиной, без обращения к строкам.
+// Порог — верхняя граница корзины
+template <typename Criterion>
+double histogramScore(const BuildContext& ctx, ContingencyTable& table,
+                      const std::vector<int>& histogram, int attrIndex,
+                      double& threshold) {
+    const std::size_t numClasses = ctx.data.labelDict.size();
+    const std::vector<double>& edges = ctx.data.binEdges[attrIndex];
+    const std::size_t numBins = edges.size();
+    const int* hist = histogram.data() + ctx.histogramOffsets[attrIndex];
+
+    table.numValues = 2;
+    table.numClasses = numClasses;
+    table.counts.assign(3 * numClasses, 0);
+    table.valueTotals.assign(2, 0);
+    table.classTotals.assign(numClasses, 0);
+    for (std::size_t b = 0; b <= numBins; ++b) {
+        const std::size_t row = b < numBins ? 1 : 2;
+        for (std::size_t c = 0; c < numClasses; ++c) {
+            const int count = hist[b * numClasses + c];
+            table.counts[row * numClasses + c] += count;
+            table.classTotals[c] += count;
+            if (b < numBins) table.valueTotals[1] += count;
+        }
+    }
+    table.known = table.valueTotals[1];
+    table.total = table.known;
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        table.total += table.counts[2 * numClasses + c];
+    }
+
+    double best = -std::numeric_limits<double>::infinity();
+    for (std::size_t b = 0; b + 1 < numBins; ++b) {
+        int moved = 0;
+        for (std::size_t c = 0; c < numClasses; ++c) {
+            const int count = hist[b * numClasses + c];
+            table.counts[c] += count;
+            table.counts[numClasses + c] -= count;
+            moved += count;
+        }
+        table.valueTotals[0] += moved;
+        table.valueTotals[1] -= moved;
+
+        // Пустая корзина не даёт нового разбиения
+        if (moved == 0 || table.valueTotals[1] == 0) continue;
+
+        const double score = Criterion::score(table);
+        if (score > best) {
+            best = score;
+            threshold = edges[b];
+        }
+    }
+    return best;
+}
+
+// Выбор атрибута с максимальной оценкой критерия.
+// Оценки кандидатов считаются (возможно, параллельно) в массив gains,
+// а максимум ищется последовательно в порядке availableAttributes —
+// результат не зависит от числа потоков. -1 — делить узел не стоит.
+// Для числового атрибута в threshold возвращается лучший порог, для
+// категориального при groupsValues — его ветки (groups, numGroups).
+template <typename Criterion>
+int chooseBestAttribute(BuildContext& ctx, RowRange range,
+                        const std::vector<int>& availableAttributes,
+                        const std::vector<int>& histogram,
+                        double& threshold,
+                        std::vector<int>& groups,
+                        std::size_t& numGroups) {
+    std::vector<double> gains(availableAttributes.size());
+    std::vector<double> thresholds(availableAttributes.size(), 0.0);
+    std::vector<std::vector<int>> groupings(
+        Criterion::groupsValues ? availableAttributes.size() : 0);
+    std::vector<std::size_t> groupCounts(groupings.size(), 0);
+
+    auto score = [&](std::size_t k, unsigned slot) {
+        const int attr = availableAttributes[k];
+        if (ctx.data.isBinned(attr)) {
+            gains[k] = histogramScore<Criterion>(ctx, ctx.tables[slot], histogram,
+                                                 attr, thresholds[k]);
+        } else if (ctx.data.isNumeric(attr)) {
+            gains[k] = thresholdScore<Criterion>(ctx, ctx.tables[slot], range,
+                                                 attr, thresholds[k]);
+        } else if constexpr (Criterion::groupsValues) {
+            gains[k] = attributeSplit<Criterion>(ctx, ctx.tables[slot], range, attr,
+                                                 groupings[k], groupCounts[k]);
+        } else {
+            gains[k] = attributeScore<Criterion>(ctx, ctx.tables[slot], range, attr);
+        }
+    };
+
+    if (ctx.pool && availableAttributes.size() > 1 &&
+        range.size() >= ctx.options.parallelScoringMinRows) {
+        ctx.pool->parallelFor(availableAttributes.size(), score);
+    } else {
+        const unsigned slot = ctx.pool ? ctx.pool->currentSlot() : 0;
+        for (std::size_t k = 0; k < availableAttributes.size(); ++k) {
+            score(k, slot);
+        }
+    }
+
+    double bestGain = Criterion::minScore;
+    int bestAttr = -1;
+    std::size_t best = 0;
+    for (std::size_t k = 0; k < availableAttributes.size(); ++k) {
+        if (gains[k] > bestGain) {
+            bestGain = gains[k];
+            bestAttr = availableAttributes[k];
+            threshold = thresholds[k];
+            best = k;
+        }
+    }
+    if constexpr (Criterion::groupsValues) {
+        if (bestAttr != -1) {
+            groups = std::move(groupings[best]);
+            numGroups = groupCounts[best];
+        }
+    }
+    return bestAttr;
+}
+
+template <typename Criterion>
+TreeNode* buildNode(BuildContext& ctx, RowRange range,
+                    const std::vector<int>& availableAttributes,
+                    std::vector<int> histogram, std::uint64_t seed);
+
+// Поддеревья для непустых веток parts (histograms — их гистограммы).
+// Поддиапазоны детей не пересекаются, поэтому рекурсия
+// переставляет индексы только внутри своего куска — крупные поддеревья
+// можно строить независимыми задачами. Каждая задача пишет только
+// в свою ячейку children, так что форма дерева не зависит от
+// порядка их выполнения. Исключение из любого поддерева (например,
+// std::bad_alloc арены) выходит из buildChildren, как при последовательном
+// построении.
+template <typename Criterion>
+std::vector<TreeNode*> buildChildren(BuildContext& ctx,
+                                     const std::vector<RowRange>& parts,
+                                     const std::vector<int>& availableAttributes,
+                                     std::vector<std::vector<int>>& histograms,
+                                     std::uint64_t seed) {
+    std::vector<TreeNode*> children(parts.size(), nullptr);
+    ThreadPool::TaskGroup subtrees;
+    try {
+        for (std::size_t g = 0; g < parts.size(); ++g) {
+            if (parts[g].empty()) continue;
+            if (ctx.pool && parts[g].size() >= ctx.options.parallelSubtreeMinRows) {
+                ctx.pool->run(subtrees, [&ctx, &children, &parts, &availableAttributes,
+                                         &histograms, seed, g](unsigned) {
+                    children[g] = buildNode<Criterion>(ctx, parts[g], availableAttributes,
+                                                       std::move(histograms[g]),
+                                                       mixSeed(seed, g));
+                });
+            } else {
+                children[g] = buildNode<Criterion>(ctx, parts[g], availableAttributes,
+                                                   std::move(histograms[g]),
+                                                   mixSeed(seed, g));
+            }
+        }
+    } catch (...) {
+        // Поставленные задачи ссылаются на локальные children и parts —
+        // до выхода с исключением их нужно дождаться
+        if (ctx.pool) {
+            try {
+                ctx.pool->wait(subtrees);
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+    if (ctx.pool) {
+        ctx.pool->wait(subtrees);
+    }
+    return children;
+}
+
+// histogram — гистограммы корзин узла, если их уже получил родитель;
+// seed — зерно случайного выбора атрибутов узла
+template <typename Criterion>
+TreeNode* buildNode(BuildContext& ctx, RowRange range,
+                    const std::vector<int>& availableAttributes,
+                    std::vector<int> histogram, std::uint64_t seed) {
+    // Если выборка пустая — возвращаем пустой лист (на практике такого быть не должно)
+    if (range.empty()) {
+        return makeLeaf(ctx, kUnknownCode);
+    }
+
+    const std::vector<int> classCounts = countLabels(ctx, range);
+
+    // Если все объекты одного класса — лист с этим классом
+    if (isPure(classCounts)) {
+        return makeLeaf(ctx, ctx.data.label(ctx.rows[range.begin]));
+    }
+
+    // Если атрибутов не осталось — лист с наиболее частым классом
+    if (availableAttributes.empty()) {
+        return makeLeaf(ctx, majorityClass(ctx, classCounts));
+    }
+
+    if (!ctx.histogramAttrs.empty() && histogram.empty()) {
+        fillHistograms(ctx, range, histogram);
+    }
+
+    // Случайный лес: узел выбирает только среди случайных атрибутов
+    std::vector<int> sampled;
+    const std::size_t perNode = ctx.options.attributesPerNode;
+    if (perNode != 0 && perNode < availableAttributes.size()) {
+        sampled = sampleAttributes(availableAttributes, perNode, seed);
+    }
+
+    // Выбираем атрибут с максимальной оценкой критерия
+    double threshold = 0.0;
+    std::vector<int> groups;
+    std::size_t numGroups = 0;
+    int bestAttr = chooseBestAttribute<Criterion>(
+        ctx, range, sampled.empty() ? availableAttributes : sampled, histogram, threshold,
+        groups, numGroups);
+
+    if (bestAttr == -1) {
+        // Разбиение ничего не даёт — лист с majority class
+        return makeLeaf(ctx, majorityClass(ctx, classCounts));
+    }
+
+    auto* node = ctx.arena().create<TreeNode>();
+    node->isLeaf = false;
+    node->label = ctx.attrNames[bestAttr]; // имя признака
+    node->attrIndex = bestAttr;
+
+    // Числовой атрибут: две ветки по порогу, атрибут остаётся доступным
+    if (ctx.data.isNumeric(bestAttr)) {
+        node->numeric = true;
+        node->threshold = threshold;
+
+        auto parts = partitionByThreshold(ctx, range, bestAttr, threshold);
+        auto histograms = childHistograms(ctx, range, parts, histogram);
+        histogram = {};
+        std::vector<TreeNode*> children =
+            buildChildren<Criterion>(ctx, parts, availableAttributes, histograms, seed);
+
+        node->numCodes = 2;
+        node->codeChildren = ctx.arena().allocateArray<TreeNode*>(2);
+        node->numEdges = 2;
+        node->edges = ctx.arena().allocateArray<TreeEdge>(2);
+        for (std::size_t g = 0; g < 2; ++g) {
+            node->codeChildren[g] = children[g];
+            node->edges[g] = {static_cast<Code>(g), thresholdLabel(ctx, g == 1, threshold),
+                              children[g]};
+        }
+        return node;
+    }
+
+    // Ветки узла: по одной на значение или группы значений, найденные
+    // критерием при оценке
+    const std::size_t numValues = ctx.data.attrDicts[bestAttr].size();
+    if constexpr (!Criterion::groupsValues) {
+        numGroups = numValues;
+    }
+
+    auto parts = partitionByAttribute(ctx, range, bestAttr, groups, numGroups);
+
+    // Новый список доступных атрибутов (без bestAttr)
+    std::vector<int> newAvailable;
+    if constexpr (Criterion::reusesAttributes) {
+        newAvailable = availableAttributes;
+    } else {
+        newAvailable.reserve(availableAttributes.size() - 1);
+        for (int idx : availableAttributes) {
+            if (idx != bestAttr) newAvailable.push_back(idx);
+        }
+    }
+
+    auto histograms = childHistograms(ctx, range, parts, histogram);
+    histogram = {};
+    std::vector<TreeNode*> children =
+        buildChildren<Criterion>(ctx, parts, newAvailable, histograms, seed);
+
+    // Код значения -> поддерево его ветки
+    node->numCodes = numValues;
+    node->codeChildren = ctx.arena().allocateArray<TreeNode*>(numValues);
+    for (std::size_t code = 0; code < numValues; ++code) {
+        const int group = groups.empty() ? static_cast<int>(code) : groups[code];
+        node->codeChildren[code] = group < 0 ? nullptr : children[group];
+    }
+
+    // Ветки для обхода по строкам — в порядке значений атрибута;
+    // значения одной группы ведут в общее поддерево
+    for (std::size_t code = 0; code < numValues; ++code) {
+        if (node->codeChildren[code]) ++node->numEdges;
+    }
+    node->edges = ctx.arena().allocateArray<TreeEdge>(node->numEdges);
+    std::size_t e = 0;
+    for (std::size_t code = 0; code < numValues; ++code) {
+        if (!node->codeChildren[code]) continue;
+        node->edges[e++] = {static_cast<Code>(code), ctx.values[bestAttr][code],
+                            node->codeChildren[code]};
+    }
+    std::sort(node->edges, node->edges + node->numEdges,
+              [](const TreeEdge& a, const TreeEdge& b) { return a.value < b.value; });
+
+    return node;
+}
+
+} // namespace tree_builder_detail
+
+// Построение дерева с критерием Criterion по закодированной выборке.
+// Числовые атрибуты делятся лучшим порогом (см. thresholdScore).
+// При numThreads != 1 атрибуты узла оцениваются параллельно, а крупные
+// поддеревья строятся отдельными задачами пула; при равных оценках
+// выбирается атрибут, стоящий раньше в availableAttributes, поэтому
+// дерево совпадает с последовательным построением.
+// rowCounts — кратность каждой строки в обучении (бутстреп-выборка
+// случайного леса, 0 — строка не участвует); пусто — каждая строка по разу.
+// Строки с классом kUnknownCode (выборка, закодированная словарями
+// другой, см. CsvLoadOptions::dictionaries) пропускаются.
+// Строки выборки не копируются: кратность задаёт только число копий
+// индекса строки
+template <typename Criterion>
+DecisionTree buildTree(const EncodedDataset& data,
+                       const std::vector<int>& availableAttributes,
+                       const TreeOptions& options,
+                       const std::vector<std::uint32_t>& rowCounts) {
+    using namespace tree_builder_detail;
+
+    std::unique_ptr<ThreadPool> pool = makeBuildPool(options);
+    BuildContext ctx(data, options);
+    ctx.pool = pool.get();
+
+    Arena arena;
+    prepareBuild(ctx, arena, availableAttributes, rowCounts);
+
+    const TreeNode* root = buildNode<Criterion>(ctx, {0, ctx.rows.size()},
+                                                availableAttributes, {}, options.seed);
+
+    for (auto& local : ctx.arenas) {
+        arena.merge(local);
+    }
+    return DecisionTree(std::move(arena), root);
+}
+
+template <typename Criterion>
+DecisionTree buildTree(const EncodedDataset& data,
+                       const std::vector<int>& availableAttributes,
+                       const TreeOptions& options = {}) {
+    return buildTree<Criterion>(data, availableAttributes, options, {});
+}
@@ -0,0 +1,102 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+Arena::Arena(std::size_t blockSize) : blockSize_(blockSize) {}
+
+Arena::~Arena() {
+    release();
+}
+
+Arena::Arena(Arena&& other) noexcept
+    : blockSize_(other.blockSize_),
+      head_(other.head_),
+      cur_(other.cur_),
+      end_(other.end_),
+      bytesUsed_(other.bytesUsed_) {
+    other.head_ = nullptr;
+    other.cur_ = other.end_ = nullptr;
+    other.bytesUsed_ = 0;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        release();
+        blockSize_ = other.blockSize_;
+        head_ = other.head_;
+        cur_ = other.cur_;
+        end_ = other.end_;
+        bytesUsed_ = other.bytesUsed_;
+        other.head_ = nullptr;
+        other.cur_ = other.end_ = nullptr;
+        other.bytesUsed_ = 0;
+    }
+    return *this;
+}
+
+void Arena::release() {
+    // Освобождаются только блоки — их единицы, а не объекты
+    while (head_) {
+        Block* next = head_->next;
+        ::operator delete(head_);
+        head_ = next;
+    }
+    cur_ = end_ = nullptr;
+    bytesUsed_ = 0;
+}
+
+void Arena::addBlock(std::size_t minSize) {
+    const std::size_t size = std::max(blockSize_, minSize);
+    auto* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = head_;
+    block->size = size;
+    head_ = block;
+    cur_ = reinterpret_cast<char*>(block + 1);
+    end_ = cur_ + size;
+}
+
+void* Arena::allocate(std::size_t size, std::size_t align) {
+    auto aligned = [&] {
+        auto p = reinterpret_cast<std::uintptr_t>(cur_);
+        return reinterpret_cast<char*>((p + align - 1) & ~(std::uintptr_t(align) - 1));
+    };
+
+    char* p = cur_ ? aligned() : nullptr;
+    if (!p || p + size > end_) {
+        addBlock(size + align);
+        p = aligned();
+    }
+    cur_ = p + size;
+    bytesUsed_ += size;
+    return p;
+}
+
+std::string_view Arena::copyString(std::string_view text) {
+    if (text.empty()) return {};
+    char* p = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(p, text.data(), text.size());
+    return {p, text.size()};
+}
+
+void Arena::merge(Arena& other) {
+    if (!other.head_ || &other == this) return;
+
+    if (!head_) {
+        head_ = other.head_;
+        cur_ = other.cur_;
+        end_ = other.end_;
+    } else {
+        // Блоки other встают сразу за текущим блоком этой арены
+        Block* tail = other.head_;
+        while (tail->next) tail = tail->next;
+        tail->next = head_->next;
+        head_->next = other.head_;
+    }
+    bytesUsed_ += other.bytesUsed_;
+
+    other.head_ = nullptr;
+    other.cur_ = other.end_ = nullptr;
+    other.bytesUsed_ = 0;
+}
@@ -0,0 +1,246 @@
+#include "binary_dataset.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr char kMagic[4] = {'S', '1', '3', 'D'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kColumnAlignment = 64;
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t numRows;
+    std::uint32_t numAttrs;
+    std::uint32_t reserved;
+};
+
+void writeString(std::ofstream& out, const std::string& text) {
+    const auto size = static_cast<std::uint32_t>(text.size());
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+void writeDictionary(std::ofstream& out, const ValueDictionary& dict) {
+    const auto size = static_cast<std::uint32_t>(dict.size());
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    for (const auto& value : dict.values) {
+        writeString(out, value);
+    }
+}
+
+void writePadding(std::ofstream& out) {
+    static const char zeros[kColumnAlignment] = {};
+    const auto pos = static_cast<std::size_t>(out.tellp());
+    const std::size_t pad = (kColumnAlignment - pos % kColumnAlignment) % kColumnAlignment;
+    out.write(zeros, static_cast<std::streamsize>(pad));
+}
+
+// Последовательное чтение заголовка отображённого файла с проверкой границ
+class Reader {
+public:
+    Reader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+    bool read(void* dst, std::size_t n) {
+        if (size_ - pos_ < n) return false;
+        std::memcpy(dst, data_ + pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+    bool readString(std::string_view& text) {
+        std::uint32_t n = 0;
+        if (!read(&n, sizeof(n)) || size_ - pos_ < n) return false;
+        text = std::string_view(data_ + pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+    bool readDictionary(ValueDictionary& dict) {
+        std::uint32_t n = 0;
+        if (!read(&n, sizeof(n)) || n > kUnknownCode) return false;
+        for (std::uint32_t i = 0; i < n; ++i) {
+            std::string_view value;
+            if (!readString(value)) return false;
+            dict.encode(value);
+        }
+        // Повторяющиеся значения означают повреждённый словарь
+        return dict.size() == n;
+    }
+
+    void alignTo(std::size_t alignment) {
+        pos_ = (pos_ + alignment - 1) / alignment * alignment;
+    }
+
+    // Массив из count кодов начиная с текущей позиции
+    const Code* codes(std::size_t count) {
+        if (pos_ > size_ || (size_ - pos_) / sizeof(Code) < count) return nullptr;
+        const auto* p = reinterpret_cast<const Code*>(data_ + pos_);
+        pos_ += count * sizeof(Code);
+        return p;
+    }
+
+    // Байт до конца файла
+    std::size_t remaining() const { return pos_ < size_ ? size_ - pos_ : 0; }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+// Все коды столбца меньше limit или равны kUnknownCode (пропуск; только
+// при allowUnknown). Сдвиг на единицу переводит kUnknownCode в 0, так что
+// проверка сводится к максимуму по столбцу без ветвлений
+bool codesBelow(const Code* column, std::size_t count, std::size_t limit,
+                bool allowUnknown) {
+    Code maxShifted = 0;
+    Code maxCode = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        maxShifted = std::max<Code>(maxShifted, static_cast<Code>(column[i] + 1));
+        maxCode = std::max<Code>(maxCode, column[i]);
+    }
+    return allowUnknown ? maxShifted <= limit : count == 0 || maxCode < limit;
+}
+
+} // namespace
+
+bool saveDatasetBinary(const std::string& filename, const EncodedDataset& data) {
+    namespace fs = std::filesystem;
+
+    if (data.hasNumericAttributes()) {
+        std::cerr << "Бинарный формат выборки не поддерживает числовые атрибуты: "
+                  << filename << '\n';
+        return false;
+    }
+
+    fs::path path(filename);
+    fs::path dir = path.parent_path();
+    if (!dir.empty()) {
+        fs::create_directories(dir);
+    }
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << "Не удалось открыть файл для записи: " << filename << '\n';
+        return false;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.numRows = data.numRows;
+    header.numAttrs = static_cast<std::uint32_t>(data.numAttrs());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // ===== ИМЕНА И СЛОВАРИ =====
+    for (const auto& name : data.attrNames) {
+        writeString(out, name);
+    }
+    for (const auto& dict : data.attrDicts) {
+        writeDictionary(out, dict);
+    }
+    writeDictionary(out, data.labelDict);
+
+    // ===== СТОЛБЦЫ КОДОВ =====
+    const auto columnBytes = static_cast<std::streamsize>(data.numRows * sizeof(Code));
+    for (std::size_t a = 0; a < data.numAttrs(); ++a) {
+        writePadding(out);
+        out.write(reinterpret_cast<const char*>(data.column(static_cast<int>(a))), columnBytes);
+    }
+    writePadding(out);
+    out.write(reinterpret_cast<const char*>(data.labelCodes()), columnBytes);
+
+    if (!out) {
+        std::cerr << "Ошибка записи файла: " << filename << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool loadDatasetBinary(const std::string& filename, EncodedDataset& out,
+                       bool validateCodes) {
+    auto file = std::make_shared<MappedFile>();
+    // Столбцы читаются при каждом обучении заново, по индексам строк узлов
+    if (!file->open(filename, MappedFile::Access::Normal)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << '\n';
+        return false;
+    }
+
+    auto fail = [&](const char* what) {
+        std::cerr << what << ": " << filename << '\n';
+        return false;
+    };
+
+    Reader reader(file->data(), file->size());
+    FileHeader header{};
+    if (!reader.read(&header, sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail("Файл не является бинарной выборкой");
+    }
+    if (header.version != kVersion) {
+        return fail("Неподдерживаемая версия бинарной выборки");
+    }
+
+    // Каждое имя атрибута занимает хотя бы 4 байта длины, каждая строка —
+    // 2 байта на столбец: иначе заголовок испорчен (и resize ниже не должен
+    // получить произвольное число)
+    if (header.numAttrs > reader.remaining() / sizeof(std::uint32_t) ||
+        header.numRows > file->size() / sizeof(Code)) {
+        return fail("Повреждён заголовок бинарной выборки");
+    }
+
+    EncodedDataset ds;
+    ds.numRows = static_cast<std::size_t>(header.numRows);
+
+    // ===== ИМЕНА И СЛОВАРИ =====
+    ds.attrNames.resize(header.numAttrs);
+    for (auto& name : ds.attrNames) {
+        std::string_view text;
+        if (!reader.readString(text)) return fail("Повреждён заголовок бинарной выборки");
+        name.assign(text);
+    }
+    ds.attrDicts.resize(header.numAttrs);
+    for (auto& dict : ds.attrDicts) {
+        if (!reader.readDictionary(dict)) return fail("Повреждён словарь бинарной выборки");
+    }
+    if (!reader.readDictionary(ds.labelDict)) {
+        return fail("Повреждён словарь бинарной выборки");
+    }
+
+    // ===== СТОЛБЦЫ КОДОВ (без копирования) =====
+    ds.mappedColumns.resize(header.numAttrs);
+    for (auto& column : ds.mappedColumns) {
+        reader.alignTo(kColumnAlignment);
+        column = reader.codes(ds.numRows);
+        if (!column) return fail("Файл бинарной выборки обрезан");
+    }
+    reader.alignTo(kColumnAlignment);
+    ds.mappedLabels = reader.codes(ds.numRows);
+    if (!ds.mappedLabels) return fail("Файл бинарной выборки обрезан");
+
+    // Коды индексируют словари и таблицы построителя без проверок; по
+    // запросу — один проход по столбцам: код атрибута — из его словаря
+    // или пропуск, код класса — только из словаря классов
+    if (validateCodes) {
+        for (std::size_t a = 0; a < ds.mappedColumns.size(); ++a) {
+            if (!codesBelow(ds.mappedColumns[a], ds.numRows, ds.attrDicts[a].size(), true)) {
+                return fail("Код вне словаря атрибута в бинарной выборке");
+            }
+        }
+        if (!codesBelow(ds.mappedLabels, ds.numRows, ds.labelDict.size(), false)) {
+            return fail("Код вне словаря классов в бинарной выборке");
+        }
+    }
+
+    ds.mapping = std::move(file);
+    out = std::move(ds);
+    return true;
+}
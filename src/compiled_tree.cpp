@@ -0,0 +1,179 @@
+#include "compiled_tree.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+const std::string& CompiledTree::className(int code) const {
+    static const std::string unknown = "Неизвестно";
+    if (code < 0 || code >= static_cast<int>(classNames.size())) return unknown;
+    return classNames[code];
+}
+
+CompiledTree compileTree(const DecisionTree& tree) {
+    CompiledTree compiled;
+    if (!tree.root()) return compiled;
+
+    // Обход в ширину: индекс узла назначается при постановке в очередь,
+    // поэтому таблицу детей родителя можно заполнить сразу
+    std::deque<std::pair<const TreeNode*, std::int32_t>> queue;
+    queue.push_back({tree.root(), 0});
+    compiled.nodes.emplace_back();
+
+    while (!queue.empty()) {
+        auto [node, index] = queue.front();
+        queue.pop_front();
+
+        FlatNode flat;
+        if (node->isLeaf) {
+            flat.attr = -1;
+            if (node->classCode == kUnknownCode) {
+                flat.offset = kNoClass;
+            } else {
+                flat.offset = node->classCode;
+                if (compiled.classNames.size() <= node->classCode) {
+                    compiled.classNames.resize(node->classCode + 1);
+                }
+                compiled.classNames[node->classCode] = std::string(node->label);
+            }
+        } else {
+            flat.attr = node->attrIndex;
+            flat.offset = static_cast<std::uint32_t>(compiled.childTable.size());
+            flat.numCodes = node->numeric ? kThresholdNode
+                                          : static_cast<std::uint32_t>(node->numCodes);
+            if (node->numeric) {
+                compiled.thresholds.resize(compiled.nodes.size(), 0.0);
+                compiled.thresholds[index] = node->threshold;
+            }
+            compiled.childTable.resize(compiled.childTable.size() + node->numCodes, -1);
+            // Значения с общим поддеревом (CART) ссылаются на один узел
+            std::unordered_map<const TreeNode*, std::int32_t> assigned;
+            for (std::size_t code = 0; code < node->numCodes; ++code) {
+                const TreeNode* child = node->codeChildren[code];
+                if (!child) continue;
+                auto [it, inserted] = assigned.try_emplace(
+                    child, static_cast<std::int32_t>(compiled.nodes.size()));
+                if (inserted) {
+                    compiled.nodes.emplace_back();
+                    queue.push_back({child, it->second});
+                }
+                compiled.childTable[flat.offset + code] = it->second;
+            }
+        }
+        compiled.nodes[index] = flat;
+    }
+
+    // Пороги индексируются номером узла — массив на все узлы
+    if (!compiled.thresholds.empty()) {
+        compiled.thresholds.resize(compiled.nodes.size(), 0.0);
+    }
+    return compiled;
+}
+
+std::string classify(const CompiledTree& tree,
+                     const std::vector<Code>& encodedExample) {
+    if (tree.nodes.empty()) return "Неизвестно";
+    return tree.className(tree.predictCode(encodedExample.data()));
+}
+
+// Блоков в одной задаче при параллельной классификации
+static constexpr std::size_t kBlocksPerTask = 64;
+
+void findFlatLeaves(const FlatNode* nodes,
+                    const std::int32_t* childTable,
+                    const double* thresholds,
+                    const EncodedDataset& data,
+                    std::size_t begin, std::size_t end,
+                    std::int32_t* leaves) {
+    std::uint32_t current[kFlatBlockRows]; // текущий узел каждой строки
+    std::uint32_t active[kFlatBlockRows];  // номера ещё не дошедших до листа строк
+    std::size_t numActive = end - begin;
+    for (std::size_t i = 0; i < numActive; ++i) {
+        current[i] = 0;
+        active[i] = static_cast<std::uint32_t>(i);
+    }
+
+    while (numActive > 0) {
+        std::size_t stillActive = 0;
+        for (std::size_t k = 0; k < numActive; ++k) {
+            const std::uint32_t i = active[k];
+            const FlatNode& node = nodes[current[i]];
+
+            if (node.attr < 0) {
+                leaves[i] = static_cast<std::int32_t>(current[i]);
+                continue;
+            }
+
+            std::int32_t next;
+            if (node.numCodes == kThresholdNode) {
+                const double value = data.number(begin + i, node.attr);
+                next = std::isnan(value)
+                           ? -1
+                           : childTable[node.offset + (value > thresholds[current[i]])];
+            } else {
+                const Code value = data.code(begin + i, node.attr);
+                next = value < node.numCodes ? childTable[node.offset + value] : -1;
+            }
+            if (next < 0) {
+                leaves[i] = -1; // значение не встречалось в обучении
+                continue;
+            }
+
+            current[i] = static_cast<std::uint32_t>(next);
+            active[stillActive++] = i;
+        }
+        numActive = stillActive;
+    }
+}
+
+// Классы блока строк [begin, end) по листам пакетного спуска
+static void classifyBlock(const CompiledTree& tree,
+                          const EncodedDataset& batch,
+                          std::size_t begin, std::size_t end,
+                          std::int32_t* out) {
+    std::int32_t leaves[kFlatBlockRows];
+    findFlatLeaves(tree.nodes.data(), tree.childTable.data(), tree.thresholds.data(),
+                   batch, begin, end, leaves);
+    for (std::size_t i = 0; i < end - begin; ++i) {
+        const std::int32_t leaf = leaves[i];
+        out[begin + i] = leaf < 0 || tree.nodes[leaf].offset == kNoClass
+                             ? -1
+                             : static_cast<std::int32_t>(tree.nodes[leaf].offset);
+    }
+}
+
+void classifyBatch(const CompiledTree& tree,
+                   const EncodedDataset& batch,
+                   std::int32_t* out,
+                   unsigned numThreads) {
+    const std::size_t numRows = batch.numRows;
+    if (tree.nodes.empty()) {
+        std::fill(out, out + numRows, -1);
+        return;
+    }
+
+    const std::size_t numBlocks = (numRows + kFlatBlockRows - 1) / kFlatBlockRows;
+    auto runBlocks = [&](std::size_t firstBlock, std::size_t lastBlock) {
+        for (std::size_t b = firstBlock; b < lastBlock; ++b) {
+            const std::size_t begin = b * kFlatBlockRows;
+            classifyBlock(tree, batch, begin,
+                          std::min(begin + kFlatBlockRows, numRows), out);
+        }
+    };
+
+    if (numThreads == 1 || numBlocks <= kBlocksPerTask) {
+        runBlocks(0, numBlocks);
+        return;
+    }
+
+    // Каждая задача пишет только в свой диапазон out — синхронизация не нужна
+    ThreadPool pool(numThreads);
+    const std::size_t numTasks = (numBlocks + kBlocksPerTask - 1) / kBlocksPerTask;
+    pool.parallelFor(numTasks, [&](std::size_t task, unsigned) {
+        runBlocks(task * kBlocksPerTask,
+                  std::min((task + 1) * kBlocksPerTask, numBlocks));
+    });
+}
@@ -0,0 +1,51 @@
+#include "count_tree.h"
+
+namespace count_tree_detail {
+
+Code majorityClass(const ClassCounts& counts, const ValueDictionary& labels) {
+    int best = -1;
+    for (std::size_t c = 0; c < counts.size(); ++c) {
+        if (counts[c] == 0) continue;
+        if (best == -1 || counts[c] > counts[best] ||
+            (counts[c] == counts[best] && labels.values[c] < labels.values[best])) {
+            best = static_cast<int>(c);
+        }
+    }
+    return best == -1 ? kUnknownCode : static_cast<Code>(best);
+}
+
+bool isPure(const ClassCounts& counts) {
+    int nonEmpty = 0;
+    for (std::uint32_t count : counts) {
+        if (count > 0) ++nonEmpty;
+    }
+    return nonEmpty <= 1;
+}
+
+// Та же раскладка, что у fillContingencyTable: строки значений, затем
+// строка пропусков
+void fillTable(ContingencyTable& table, const std::vector<ClassCounts>& byValue,
+               const ClassCounts& missing, std::size_t numClasses) {
+    table.numValues = byValue.size();
+    table.numClasses = numClasses;
+    table.counts.assign((byValue.size() + 1) * numClasses, 0);
+    table.valueTotals.assign(byValue.size(), 0);
+    table.classTotals.assign(numClasses, 0);
+    table.total = 0;
+    table.known = 0;
+    for (std::size_t v = 0; v <= byValue.size(); ++v) {
+        const ClassCounts& classes = v < byValue.size() ? byValue[v] : missing;
+        for (std::size_t c = 0; c < classes.size(); ++c) {
+            const int count = static_cast<int>(classes[c]);
+            table.counts[v * numClasses + c] += count;
+            table.classTotals[c] += count;
+            table.total += count;
+            if (v < byValue.size()) {
+                table.valueTotals[v] += count;
+                table.known += count;
+            }
+        }
+    }
+}
+
+} // namespace count_tree_detail
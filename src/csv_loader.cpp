@@ -0,0 +1,473 @@
+#include "csv_loader.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Первый ';' или '\n' в [p, end), либо end. Основной цикл сравнивает
+// сразу 16 байт (SSE2) и по маске находит ближайший разделитель.
+inline const char* findDelimiter(const char* p, const char* end) {
+#ifdef __SSE2__
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, semicolon), _mm_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != ';' && *p != '\n') ++p;
+    return p;
+}
+
+// Разбор строк CSV в закодированную выборку. Получает только целые
+// строки; первая строка — заголовок (если он не задан через useHeader).
+// Поля — string_view прямо в буфере (или в отображённом файле),
+// в выборку попадают только коды.
+class CsvParser {
+public:
+    // numericAttributes — имена столбцов, значения которых разбираются в числа;
+    // reference — выборка, словарями которой кодируются значения (nullptr —
+    // словари строятся по ходу разбора)
+    CsvParser(EncodedDataset& out, const std::vector<std::string>& numericAttributes,
+              const EncodedDataset* reference = nullptr)
+        : out_(out), numericAttributes_(numericAttributes), reference_(reference) {}
+
+    // Заголовок уже известен: разбираются только строки данных
+    void useHeader(const std::vector<std::string>& attrNames,
+                   const std::vector<AttributeType>& attrTypes) {
+        out_.attrNames = attrNames;
+        out_.attrTypes = attrTypes;
+        out_.attrDicts.resize(attrNames.size());
+        out_.columns.resize(attrNames.size());
+        out_.numbers.resize(attrNames.size());
+        headerDone_ = true;
+    }
+
+    // Разбор строк из [begin, end); end — сразу после '\n' или конец файла
+    bool parseLines(const char* begin, const char* end) {
+        while (begin < end) {
+            const char* delim = findDelimiter(begin, end);
+            const bool lineEnd = delim == end || *delim == '\n';
+
+            std::string_view field(begin, static_cast<std::size_t>(delim - begin));
+            // Windows-окончания строк
+            if (lineEnd && !field.empty() && field.back() == '\r') {
+                field.remove_suffix(1);
+            }
+
+            if (!onField(field, lineEnd)) return false;
+            begin = delim == end ? end : delim + 1;
+        }
+        return true;
+    }
+
+    bool sawHeader() const { return headerDone_; }
+
+    // Разобрано строк (включая заголовок и пустые)
+    std::size_t linesParsed() const { return lineNumber_; }
+
+    // Описание ошибки разбора и номер строки с ней (с 1, от начала разбора)
+    const std::string& error() const { return error_; }
+    std::size_t errorLine() const { return errorLine_; }
+
+private:
+    bool onField(std::string_view value, bool lineEnd) {
+        if (field_ == 0 && lineEnd && value.empty()) {
+            ++lineNumber_; // пустая строка
+            return true;
+        }
+
+        if (!headerDone_) {
+            header_.emplace_back(value);
+            if (lineEnd) return finishHeader();
+            return true;
+        }
+
+        const std::size_t numAttrs = out_.numAttrs();
+        try {
+            if (field_ < numAttrs && !lineEnd) {
+                if (out_.isNumeric(static_cast<int>(field_))) {
+                    out_.numbers[field_].push_back(parseNumber(value));
+                } else {
+                    out_.columns[field_].push_back(
+                        reference_ ? reference_->attrDicts[field_].find(value)
+                                   : out_.attrDicts[field_].encode(value));
+                }
+            } else if (field_ == numAttrs && lineEnd) {
+                out_.labels.push_back(reference_ ? reference_->labelDict.find(value)
+                                                 : out_.labelDict.encode(value));
+                ++out_.numRows;
+            } else {
+                return reportBadLine();
+            }
+        } catch (const std::length_error&) {
+            // Словарь столбца исчерпал коды (см. ValueDictionary::encode)
+            error_ = "Слишком много различных значений в столбце " +
+                     (field_ < numAttrs ? out_.attrNames[field_] : std::string("класса"));
+            errorLine_ = lineNumber_ + 1;
+            return false;
+        }
+
+        ++field_;
+        if (lineEnd) {
+            field_ = 0;
+            ++lineNumber_;
+        }
+        return true;
+    }
+
+    bool finishHeader() {
+        ++lineNumber_;
+        if (header_.size() < 2) {
+            error_ = "В CSV нет атрибутов";
+            errorLine_ = lineNumber_;
+            return false;
+        }
+
+        header_.pop_back(); // последний столбец — класс
+
+        // Словари образца: атрибуты должны идти в том же порядке,
+        // а типы и словари берутся из образца целиком
+        if (reference_) {
+            if (header_ != reference_->attrNames) {
+                error_ = "Заголовок не совпадает с атрибутами обучающей выборки";
+                errorLine_ = lineNumber_;
+                return false;
+            }
+            out_.attrNames = std::move(header_);
+            out_.attrTypes = reference_->attrTypes;
+            out_.attrDicts = reference_->attrDicts;
+            out_.labelDict = reference_->labelDict;
+            out_.columns.resize(out_.attrNames.size());
+            out_.numbers.resize(out_.attrNames.size());
+            headerDone_ = true;
+            return true;
+        }
+
+        out_.attrNames = std::move(header_);
+        out_.attrDicts.resize(out_.attrNames.size());
+        out_.columns.resize(out_.attrNames.size());
+        out_.numbers.resize(out_.attrNames.size());
+        if (!numericAttributes_.empty()) {
+            out_.attrTypes.assign(out_.attrNames.size(), AttributeType::Categorical);
+            for (std::size_t a = 0; a < out_.attrNames.size(); ++a) {
+                if (std::find(numericAttributes_.begin(), numericAttributes_.end(),
+                              out_.attrNames[a]) != numericAttributes_.end()) {
+                    out_.attrTypes[a] = AttributeType::Numeric;
+                }
+            }
+        }
+        headerDone_ = true;
+        return true;
+    }
+
+    bool reportBadLine() {
+        error_ = "Неверное число столбцов";
+        errorLine_ = lineNumber_ + 1;
+        return false;
+    }
+
+    EncodedDataset& out_;
+    const std::vector<std::string>& numericAttributes_;
+    const EncodedDataset* reference_;
+    std::string error_;
+    std::size_t errorLine_ = 0;
+    std::vector<std::string> header_;
+    std::size_t field_ = 0;      // номер поля в текущей строке
+    std::size_t lineNumber_ = 0; // разобрано строк
+    bool headerDone_ = false;
+};
+
+// Последний перевод строки в [begin, end) или nullptr
+const char* findLastNewline(const char* begin, const char* end) {
+    while (end > begin) {
+        --end;
+        if (*end == '\n') return end;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+// Потоковое чтение файла блоками
+static bool loadStreaming(const std::string& filename,
+                          CsvParser& parser,
+                          const CsvLoadOptions& options) {
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << '\n';
+        return false;
+    }
+
+    // Буфер: [0, filled) — прочитанные, но ещё не разобранные байты.
+    // Разбираются только целые строки, хвост переносится в начало буфера.
+    std::vector<char> buffer(std::max<std::size_t>(options.chunkSize, 4096));
+    std::size_t filled = 0;
+    bool eof = false;
+    bool ok = true;
+
+    while (ok && !eof) {
+        const std::size_t want = buffer.size() - filled;
+        const std::size_t got = std::fread(buffer.data() + filled, 1, want, file);
+        filled += got;
+        eof = got < want;
+
+        const char* begin = buffer.data();
+        const char* last = findLastNewline(begin, begin + filled);
+        const char* end = eof ? begin + filled : (last ? last + 1 : nullptr);
+
+        if (!end) {
+            // Строка длиннее буфера — увеличиваем его
+            buffer.resize(buffer.size() * 2);
+            continue;
+        }
+
+        ok = parser.parseLines(begin, end);
+
+        const std::size_t consumed = static_cast<std::size_t>(end - begin);
+        std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+    }
+
+    const bool readError = std::ferror(file) != 0;
+    std::fclose(file);
+
+    if (readError) {
+        std::cerr << "Ошибка чтения файла: " << filename << '\n';
+        return false;
+    }
+    return ok;
+}
+
+// Разбор отображённого в память файла целиком, без копирования
+static bool loadMapped(const std::string& filename, CsvParser& parser) {
+    MappedFile file;
+    if (!file.open(filename, MappedFile::Access::Sequential)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << '\n';
+        return false;
+    }
+    return parser.parseLines(file.data(), file.data() + file.size());
+}
+
+// Сообщение об ошибке разбора; firstLine — номер строки файла,
+// с которой начинал разбор этот парсер
+static void printParseError(const CsvParser& parser,
+                            const std::string& filename,
+                            std::size_t firstLine = 1) {
+    std::cerr << parser.error() << " в строке "
+              << firstLine + parser.errorLine() - 1
+              << " файла " << filename << '\n';
+}
+
+// Результат разбора одного куска файла в многопоточном режиме
+struct CsvChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    EncodedDataset local;        // локальные словари и коды куска
+    std::size_t firstRow = 0;    // номер первой строки куска в итоговой выборке
+    std::size_t firstLine = 0;   // номер первой строки куска в файле
+    std::size_t linesParsed = 0;
+    bool ok = true;
+    std::string error;
+    std::size_t errorLine = 0;
+};
+
+// Начало первой целой строки не раньше p (p == begin — уже начало строки)
+static const char* alignToLine(const char* begin, const char* p, const char* end) {
+    if (p <= begin) return begin;
+    if (p >= end) return end;
+    if (p[-1] == '\n') return p;
+    const char* newline = static_cast<const char*>(
+        std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+    return newline ? newline + 1 : end;
+}
+
+// Многопоточный разбор отображённого файла: заголовок читается сразу,
+// тело режется на куски по границам строк, каждый кусок кодируется своими
+// словарями, после чего словари сливаются в порядке кусков. Порядок
+// первого появления значений при этом тот же, что и при чтении подряд,
+// поэтому результат совпадает с однопоточной загрузкой.
+static bool loadParallel(const std::string& filename,
+                         EncodedDataset& ds,
+                         const CsvLoadOptions& options) {
+    MappedFile file;
+    if (!file.open(filename, MappedFile::Access::Sequential)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << '\n';
+        return false;
+    }
+    const char* data = file.data();
+    const char* fileEnd = data + file.size();
+
+    // ===== ЗАГОЛОВОК (и пустые строки перед ним) =====
+    CsvParser headerParser(ds, options.numericAttributes, options.dictionaries);
+    const char* body = data;
+    while (body < fileEnd && !headerParser.sawHeader()) {
+        const char* newline = static_cast<const char*>(
+            std::memchr(body, '\n', static_cast<std::size_t>(fileEnd - body)));
+        const char* lineEnd = newline ? newline + 1 : fileEnd;
+        if (!headerParser.parseLines(body, lineEnd)) {
+            printParseError(headerParser, filename);
+            return false;
+        }
+        body = lineEnd;
+    }
+    if (!headerParser.sawHeader()) {
+        std::cerr << "Пустой CSV-файл: " << filename << '\n';
+        return false;
+    }
+
+    // ===== РАЗБИЕНИЕ ТЕЛА НА КУСКИ =====
+    ThreadPool pool(options.numThreads);
+    const std::size_t bodySize = static_cast<std::size_t>(fileEnd - body);
+    const std::size_t numChunks = std::max<std::size_t>(
+        1, std::min<std::size_t>(pool.concurrency() * 4,
+                                 bodySize / std::max<std::size_t>(options.chunkSize, 1)));
+
+    std::vector<CsvChunk> chunks(numChunks);
+    for (std::size_t k = 0; k < numChunks; ++k) {
+        chunks[k].begin = alignToLine(body, body + bodySize * k / numChunks, fileEnd);
+    }
+    for (std::size_t k = 0; k < numChunks; ++k) {
+        chunks[k].end = k + 1 < numChunks ? chunks[k + 1].begin : fileEnd;
+    }
+
+    pool.parallelFor(numChunks, [&](std::size_t k, unsigned) {
+        CsvChunk& chunk = chunks[k];
+        CsvParser parser(chunk.local, options.numericAttributes, options.dictionaries);
+        parser.useHeader(ds.attrNames, ds.attrTypes);
+        chunk.ok = parser.parseLines(chunk.begin, chunk.end);
+        chunk.linesParsed = parser.linesParsed();
+        chunk.error = parser.error();
+        chunk.errorLine = parser.errorLine();
+    });
+
+    // Номера строк нужны и для сообщений об ошибках, и для раскладки кодов
+    std::size_t line = headerParser.linesParsed() + 1;
+    std::size_t row = 0;
+    for (auto& chunk : chunks) {
+        chunk.firstLine = line;
+        chunk.firstRow = row;
+        if (!chunk.ok) {
+            std::cerr << chunk.error << " в строке "
+                      << chunk.firstLine + chunk.errorLine - 1
+                      << " файла " << filename << '\n';
+            return false;
+        }
+        line += chunk.linesParsed;
+        row += chunk.local.numRows;
+    }
+
+    // ===== СЛИЯНИЕ СЛОВАРЕЙ =====
+    // remap[k][a][локальный код] — глобальный код; последний столбец — класс.
+    // Со словарями образца куски уже закодированы общими кодами
+    const std::size_t numAttrs = ds.numAttrs();
+    const bool remapCodes = options.dictionaries == nullptr;
+    std::vector<std::vector<std::vector<Code>>> remap(numChunks);
+    for (std::size_t k = 0; k < numChunks && remapCodes; ++k) {
+        remap[k].resize(numAttrs + 1);
+        for (std::size_t a = 0; a <= numAttrs; ++a) {
+            const ValueDictionary& local =
+                a < numAttrs ? chunks[k].local.attrDicts[a] : chunks[k].local.labelDict;
+            ValueDictionary& global = a < numAttrs ? ds.attrDicts[a] : ds.labelDict;
+            remap[k][a].reserve(local.size());
+            try {
+                for (const auto& value : local.values) {
+                    remap[k][a].push_back(global.encode(value));
+                }
+            } catch (const std::length_error&) {
+                // Каждый кусок уложился в коды, а общий словарь — нет
+                std::cerr << "Слишком много различных значений в столбце "
+                          << (a < numAttrs ? ds.attrNames[a] : std::string("класса"))
+                          << " файла " << filename << '\n';
+                return false;
+            }
+        }
+    }
+
+    // ===== ПЕРЕКОДИРОВАНИЕ В ОБЩИЕ СТОЛБЦЫ =====
+    // Числовые столбцы словарей не имеют и копируются как есть
+    ds.numRows = row;
+    for (std::size_t a = 0; a < numAttrs; ++a) {
+        if (ds.isNumeric(static_cast<int>(a))) {
+            ds.numbers[a].resize(row);
+        } else {
+            ds.columns[a].resize(row);
+        }
+    }
+    ds.labels.resize(row);
+
+    pool.parallelFor(numChunks * (numAttrs + 1), [&](std::size_t task, unsigned) {
+        const std::size_t k = task / (numAttrs + 1);
+        const std::size_t a = task % (numAttrs + 1);
+        const CsvChunk& chunk = chunks[k];
+        if (a < numAttrs && ds.isNumeric(static_cast<int>(a))) {
+            std::copy(chunk.local.numbers[a].begin(), chunk.local.numbers[a].end(),
+                      ds.numbers[a].begin() + chunk.firstRow);
+            return;
+        }
+        const std::vector<Code>& source =
+            a < numAttrs ? chunk.local.columns[a] : chunk.local.labels;
+        Code* target = (a < numAttrs ? ds.columns[a].data() : ds.labels.data()) + chunk.firstRow;
+        if (!remapCodes) {
+            std::copy(source.begin(), source.end(), target);
+            return;
+        }
+        const std::vector<Code>& map = remap[k][a];
+        for (std::size_t i = 0; i < source.size(); ++i) {
+            target[i] = map[source[i]];
+        }
+    });
+
+    return true;
+}
+
+bool loadEncodedDatasetCSV(const std::string& filename,
+                           EncodedDataset& out,
+                           const CsvLoadOptions& options) {
+    EncodedDataset ds;
+
+    // Со словарями образца выборка только оценивается — по значениям
+    // числовых атрибутов, без корзин
+    const bool binNumbers = options.numericBins != 0 && !options.dictionaries;
+
+    if (options.numThreads != 1) {
+        if (!loadParallel(filename, ds, options)) return false;
+        if (binNumbers) binNumericAttributes(ds, options.numericBins);
+        out = std::move(ds);
+        return true;
+    }
+
+    CsvParser parser(ds, options.numericAttributes, options.dictionaries);
+    const bool ok = options.memoryMap ? loadMapped(filename, parser)
+                                      : loadStreaming(filename, parser, options);
+    if (!ok) {
+        if (!parser.error().empty()) printParseError(parser, filename);
+        return false;
+    }
+    if (!parser.sawHeader()) {
+        std::cerr << "Пустой CSV-файл: " << filename << '\n';
+        return false;
+    }
+
+    if (binNumbers) binNumericAttributes(ds, options.numericBins);
+    out = std::move(ds);
+    return true;
+}
@@ -0,0 +1,191 @@
+#include "csv_writer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+CsvWriter::CsvWriter(const CsvWriteOptions& options) : options_(options) {
+    options_.bufferSize = std::max<std::size_t>(options_.bufferSize, 4096);
+}
+
+CsvWriter::~CsvWriter() {
+    close();
+}
+
+bool CsvWriter::open(const std::string& filename) {
+    namespace fs = std::filesystem;
+
+    close();
+
+    fs::path path(filename);
+    fs::path dir = path.parent_path();
+    if (!dir.empty()) {
+        fs::create_directories(dir);
+    }
+
+    file_ = std::fopen(filename.c_str(), "wb");
+    if (!file_) return false;
+    // Собственный буфер уже крупный — буфер stdio только лишнее копирование
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    buffer_.resize(options_.bufferSize);
+    pending_.resize(options_.bufferSize);
+    used_ = 0;
+    failed_ = false;
+    rowStarted_ = false;
+
+    if (options_.backgroundWrite) {
+        stopping_ = false;
+        hasPending_ = false;
+        writer_ = std::thread([this] { backgroundLoop(); });
+    }
+    return true;
+}
+
+void CsvWriter::field(std::string_view value) {
+    if (rowStarted_) append(";", 1);
+    append(value.data(), value.size());
+    rowStarted_ = true;
+}
+
+void CsvWriter::endRow() {
+    append("\n", 1);
+    rowStarted_ = false;
+}
+
+void CsvWriter::append(const char* data, std::size_t size) {
+    if (used_ + size > buffer_.size()) {
+        flush();
+        if (size > buffer_.size()) {
+            // Значение больше буфера — пишем его напрямую
+            waitPending();
+            writeBlock(data, size);
+            return;
+        }
+    }
+    std::memcpy(buffer_.data() + used_, data, size);
+    used_ += size;
+}
+
+void CsvWriter::writeBlock(const char* data, std::size_t size) {
+    if (size == 0 || failed_) return;
+    if (std::fwrite(data, 1, size, file_) != size) {
+        failed_ = true;
+    }
+}
+
+void CsvWriter::waitPending() {
+    if (!writer_.joinable()) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !hasPending_; });
+}
+
+void CsvWriter::flush() {
+    if (used_ == 0 || !file_) return;
+
+    if (!writer_.joinable()) {
+        writeBlock(buffer_.data(), used_);
+        used_ = 0;
+        return;
+    }
+
+    // Ждём, пока фоновый поток освободит второй буфер, и меняемся
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !hasPending_; });
+    pending_.swap(buffer_);
+    pendingSize_ = used_;
+    hasPending_ = true;
+    lock.unlock();
+    cv_.notify_all();
+
+    used_ = 0;
+}
+
+void CsvWriter::backgroundLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return hasPending_ || stopping_; });
+        if (!hasPending_) return;
+
+        // Запись идёт без блокировки: pending_ принадлежит этому потоку,
+        // пока hasPending_ == true
+        lock.unlock();
+        writeBlock(pending_.data(), pendingSize_);
+        lock.lock();
+
+        hasPending_ = false;
+        cv_.notify_all();
+    }
+}
+
+bool CsvWriter::close() {
+    if (!file_) return !failed_;
+
+    flush();
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+    }
+
+    if (std::fclose(file_) != 0) failed_ = true;
+    file_ = nullptr;
+    buffer_ = {};
+    pending_ = {};
+    return !failed_;
+}
+
+bool saveEncodedDatasetCSV(const std::string& filename,
+                           const EncodedDataset& data,
+                           const CsvWriteOptions& options) {
+    CsvWriter writer(options);
+    if (!writer.open(filename)) {
+        std::cerr << "Не удалось открыть файл для записи: " << filename << '\n';
+        return false;
+    }
+
+    // ===== ЗАГОЛОВОК =====
+    for (const auto& name : data.attrNames) {
+        writer.field(name);
+    }
+    writer.field("Решение");
+    writer.endRow();
+
+    // ===== СТРОКИ ДАННЫХ =====
+    const std::size_t numAttrs = data.numAttrs();
+    for (std::size_t row = 0; row < data.numRows; ++row) {
+        for (std::size_t a = 0; a < numAttrs; ++a) {
+            if (data.isNumeric(static_cast<int>(a))) {
+                // Кратчайшая запись, которая читается обратно в то же число
+                const double value = data.number(row, static_cast<int>(a));
+                char buffer[32];
+                const std::size_t size =
+                    std::isnan(value)
+                        ? 0
+                        : static_cast<std::size_t>(
+                              std::to_chars(buffer, buffer + sizeof(buffer), value).ptr - buffer);
+                writer.field(std::string_view(buffer, size));
+                continue;
+            }
+            const Code code = data.code(row, static_cast<int>(a));
+            writer.field(code == kUnknownCode ? std::string_view()
+                                              : std::string_view(data.attrDicts[a].values[code]));
+        }
+        const Code label = data.label(row);
+        writer.field(label == kUnknownCode ? std::string_view()
+                                           : std::string_view(data.labelDict.values[label]));
+        writer.endRow();
+    }
+
+    if (!writer.close()) {
+        std::cerr << "Ошибка записи файла: " << filename << '\n';
+        return false;
+    }
+    return true;
+}
@@ -1,7 +1,6 @@
 #include "dataset.h"
+#include "csv_writer.h"
 
-#include <filesystem>
-#include <fstream>
 #include <iostream>
 
 std::vector<std::string> getAttributeNames() {
@@ -36,39 +35,33 @@ std::vector<Example> getTrainingData() {
 void saveDatasetToCSV(const std::string& filename,
                       const std::vector<Example>& data,
                       const std::vector<std::string>& attrNames) {
-    namespace fs = std::filesystem;
-
-    fs::path path(filename);
-    fs::path dir = path.parent_path();
-    if (!dir.empty()) {
-        fs::create_directories(dir);
-    }
-
-    std::ofstream out(filename);
-    if (!out) {
+    CsvWriter out;
+    if (!out.open(filename)) {
         std::cerr << "Не удалось открыть файл для записи: " << filename << '\n';
         return;
     }
 
     // ===== ЗАГОЛОВОК =====
     // Цена;Качество;Срок поставки;Надёжность;Решение
-    for (std::size_t i = 0; i < attrNames.size(); ++i) {
-        out << attrNames[i];
-        if (i + 1 < attrNames.size()) {
-            out << ';'; // разделитель колонок — ТОЧКА С ЗАПЯТОЙ
-        }
+    // (разделитель колонок — ТОЧКА С ЗАПЯТОЙ)
+    for (const auto& name : attrNames) {
+        out.field(name);
     }
-    out << ";Решение\n";
+    out.field("Решение");
+    out.endRow();
 
     // ===== СТРОКИ ДАННЫХ =====
     for (const auto& ex : data) {
-        for (std::size_t i = 0; i < ex.attrs.size(); ++i) {
-            out << ex.attrs[i];
-            if (i + 1 < ex.attrs.size()) {
-                out << ';';
-            }
+        for (const auto& value : ex.attrs) {
+            out.field(value);
         }
-        out << ';' << ex.label << '\n';
+        out.field(ex.label);
+        out.endRow();
+    }
+
+    if (!out.close()) {
+        std::cerr << "Ошибка записи файла: " << filename << '\n';
+        return;
     }
 
     std::cout << "Таблица обучающей выборки сохранена в CSV: "
@@ -0,0 +1,214 @@
+#include "encoded_dataset.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+double parseNumber(std::string_view text) {
+    // Пробелы по краям и десятичная запятая допускаются
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+
+    char buffer[64];
+    if (text.empty() || text.size() >= sizeof(buffer)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    std::copy(text.begin(), text.end(), buffer);
+    std::replace(buffer, buffer + text.size(), ',', '.');
+
+    double value = 0.0;
+    const auto [end, ec] = std::from_chars(buffer, buffer + text.size(), value);
+    if (ec != std::errc() || end != buffer + text.size()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return value;
+}
+
+Code ValueDictionary::find(std::string_view value) const {
+    if (slots_.empty()) return kUnknownCode;
+
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = std::hash<std::string_view>{}(value) & mask;; i = (i + 1) & mask) {
+        const Code code = slots_[i];
+        if (code == kUnknownCode || values[code] == value) return code;
+    }
+}
+
+Code ValueDictionary::encode(std::string_view value) {
+    Code code = find(value);
+    if (code != kUnknownCode) {
+        return code;
+    }
+
+    if (values.size() >= kUnknownCode) {
+        throw std::length_error("Слишком много различных значений в столбце");
+    }
+
+    // Заполненность таблицы не выше 1/2
+    if ((values.size() + 1) * 2 > slots_.size()) {
+        rehash(std::max<std::size_t>(16, slots_.size() * 2));
+    }
+
+    code = static_cast<Code>(values.size());
+    values.emplace_back(value);
+
+    const std::size_t mask = slots_.size() - 1;
+    std::size_t i = std::hash<std::string_view>{}(value) & mask;
+    while (slots_[i] != kUnknownCode) i = (i + 1) & mask;
+    slots_[i] = code;
+    return code;
+}
+
+void ValueDictionary::rehash(std::size_t capacity) {
+    slots_.assign(capacity, kUnknownCode);
+    const std::size_t mask = capacity - 1;
+    for (std::size_t code = 0; code < values.size(); ++code) {
+        std::size_t i = std::hash<std::string_view>{}(values[code]) & mask;
+        while (slots_[i] != kUnknownCode) i = (i + 1) & mask;
+        slots_[i] = static_cast<Code>(code);
+    }
+}
+
+EncodedDataset encodeDataset(const std::vector<Example>& data,
+                             const std::vector<std::string>& attrNames,
+                             const std::vector<AttributeType>& attrTypes) {
+    EncodedDataset ds;
+    ds.attrNames = attrNames;
+    ds.attrTypes = attrTypes;
+    ds.attrDicts.resize(attrNames.size());
+    ds.numRows = data.size();
+    ds.columns.resize(attrNames.size());
+    ds.numbers.resize(attrNames.size());
+    for (std::size_t a = 0; a < attrNames.size(); ++a) {
+        if (ds.isNumeric(static_cast<int>(a))) {
+            ds.numbers[a].reserve(data.size());
+        } else {
+            ds.columns[a].reserve(data.size());
+        }
+    }
+    ds.labels.reserve(data.size());
+
+    for (const auto& ex : data) {
+        for (std::size_t a = 0; a < attrNames.size(); ++a) {
+            // Пропущенное значение атрибута — kUnknownCode (NaN для числовых)
+            if (ds.isNumeric(static_cast<int>(a))) {
+                ds.numbers[a].push_back(a < ex.attrs.size()
+                                            ? parseNumber(ex.attrs[a])
+                                            : std::numeric_limits<double>::quiet_NaN());
+            } else {
+                ds.columns[a].push_back(a < ex.attrs.size()
+                                            ? ds.attrDicts[a].encode(ex.attrs[a])
+                                            : kUnknownCode);
+            }
+        }
+        ds.labels.push_back(ds.labelDict.encode(ex.label));
+    }
+
+    return ds;
+}
+
+EncodedDataset encodeDataset(const std::vector<Example>& data,
+                             const EncodedDataset& reference) {
+    EncodedDataset ds;
+    ds.attrNames = reference.attrNames;
+    ds.attrTypes = reference.attrTypes;
+    ds.attrDicts = reference.attrDicts;
+    ds.labelDict = reference.labelDict;
+    ds.numRows = data.size();
+    ds.columns.resize(ds.numAttrs());
+    ds.numbers.resize(ds.numAttrs());
+
+    for (std::size_t a = 0; a < ds.numAttrs(); ++a) {
+        const bool numeric = ds.isNumeric(static_cast<int>(a));
+        if (numeric) {
+            ds.numbers[a].reserve(data.size());
+        } else {
+            ds.columns[a].reserve(data.size());
+        }
+        for (const auto& ex : data) {
+            if (numeric) {
+                ds.numbers[a].push_back(a < ex.attrs.size()
+                                            ? parseNumber(ex.attrs[a])
+                                            : std::numeric_limits<double>::quiet_NaN());
+            } else {
+                ds.columns[a].push_back(a < ex.attrs.size()
+                                            ? ds.attrDicts[a].find(ex.attrs[a])
+                                            : kUnknownCode);
+            }
+        }
+    }
+    ds.labels.reserve(data.size());
+    for (const auto& ex : data) {
+        ds.labels.push_back(ds.labelDict.find(ex.label));
+    }
+
+    return ds;
+}
+
+void binNumericAttributes(EncodedDataset& data, std::size_t maxBins) {
+    maxBins = std::clamp<std::size_t>(maxBins, 2, kMaxBins);
+    data.bins.assign(data.numAttrs(), {});
+    data.binEdges.assign(data.numAttrs(), {});
+
+    for (std::size_t a = 0; a < data.numAttrs(); ++a) {
+        if (!data.isNumeric(static_cast<int>(a))) continue;
+        const double* values = data.numberColumn(static_cast<int>(a));
+
+        std::vector<double> sorted;
+        sorted.reserve(data.numRows);
+        for (std::size_t row = 0; row < data.numRows; ++row) {
+            if (!std::isnan(values[row])) sorted.push_back(values[row]);
+        }
+        std::sort(sorted.begin(), sorted.end());
+
+        // Корзина закрывается, когда набралась очередная квантиль строк;
+        // граница — середина между последним значением корзины и следующим
+        std::vector<double>& edges = data.binEdges[a];
+        const std::size_t n = sorted.size();
+        std::size_t distinct = 0;
+        for (std::size_t k = 0; k < n; ++k) {
+            if (k == 0 || sorted[k] != sorted[k - 1]) ++distinct;
+        }
+        std::size_t i = 0;
+        while (i < n) {
+            std::size_t j = i;
+            while (j + 1 < n && sorted[j + 1] == sorted[i]) ++j; // равные значения
+            const double value = sorted[j];
+            if (j + 1 == n) {
+                edges.push_back(value);
+                break;
+            }
+            const std::size_t target = (edges.size() + 1) * n / maxBins;
+            if (distinct <= maxBins || j + 1 >= target) {
+                const double next = sorted[j + 1];
+                double edge = value + (next - value) / 2;
+                if (!(edge < next)) edge = value;
+                edges.push_back(edge);
+            }
+            i = j + 1;
+        }
+
+        std::vector<std::uint8_t>& column = data.bins[a];
+        column.resize(data.numRows);
+        for (std::size_t row = 0; row < data.numRows; ++row) {
+            column[row] = std::isnan(values[row])
+                              ? kMissingBin
+                              : static_cast<std::uint8_t>(
+                                    std::lower_bound(edges.begin(), edges.end(), values[row]) -
+                                    edges.begin());
+        }
+    }
+}
+
+std::vector<Code> encodeExample(const EncodedDataset& dataset,
+                                const Example& example) {
+    std::vector<Code> row(dataset.numAttrs(), kUnknownCode);
+    for (std::size_t a = 0; a < row.size() && a < example.attrs.size(); ++a) {
+        row[a] = dataset.attrDicts[a].find(example.attrs[a]);
+    }
+    return row;
+}
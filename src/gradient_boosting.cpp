@@ -0,0 +1,583 @@
+#include "gradient_boosting.h"
+#include "thread_pool.h"
+#include "tree_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+
+namespace {
+
+using tree_builder_detail::RowRange;
+
+// Суммы градиентов и гессианов строк одной корзины (или узла)
+struct GradientSum {
+    double grad = 0.0;
+    double hess = 0.0;
+    double count = 0.0;
+
+    void add(const GradientSum& other) {
+        grad += other.grad;
+        hess += other.hess;
+        count += other.count;
+    }
+
+    GradientSum& operator-=(const GradientSum& other) {
+        grad -= other.grad;
+        hess -= other.hess;
+        count -= other.count;
+        return *this;
+    }
+};
+
+// Лучшее разбиение узла
+struct BoostSplit {
+    double gain = 0.0;
+    int attr = -1;
+    std::size_t lastLeftBin = 0;    // числовой атрибут: корзины <= lastLeftBin — влево
+    std::vector<bool> leftCodes;    // категориальный: коды, уходящие влево
+};
+
+// В узлах меньше этого гистограммы атрибутов строятся последовательно
+constexpr std::size_t kParallelHistogramRows = 50000;
+
+// Строк в одном блоке при подсчёте счётов
+constexpr std::size_t kScoreBlockRows = kFlatBlockRows;
+
+// Состояние построения одного дерева
+struct BoostContext {
+    BoostContext(const EncodedDataset& data, const BoostingOptions& options)
+        : data(data), options(options) {}
+
+    const EncodedDataset& data;
+    const BoostingOptions& options;
+    ThreadPool* pool = nullptr;
+    const double* grad = nullptr;           // градиенты строк для текущего выхода
+    const double* hess = nullptr;
+    std::vector<std::size_t> rows;          // строки дерева, переставляются на месте
+    std::vector<std::size_t> scratch;
+    std::vector<int> attrs;                 // атрибуты раунда
+    std::vector<std::size_t> offsets;       // начало блока атрибута в гистограмме
+    std::size_t histogramSize = 0;
+    RegressionTree tree;
+};
+
+// Число корзин атрибута (без корзины пропусков): для категориального —
+// размер словаря, код значения и есть корзина
+std::size_t binCount(const EncodedDataset& data, int attr) {
+    return data.isNumeric(attr) ? data.binEdges[attr].size() : data.attrDicts[attr].size();
+}
+
+// Корзина строки; binCount — пропуск
+std::size_t binOf(const EncodedDataset& data, int attr, std::size_t row) {
+    if (data.isNumeric(attr)) {
+        const std::uint8_t bin = data.binColumn(attr)[row];
+        return bin == kMissingBin ? data.binEdges[attr].size() : bin;
+    }
+    const Code code = data.code(row, attr);
+    return code == kUnknownCode ? data.attrDicts[attr].size() : code;
+}
+
+// Гистограммы градиентов по строкам диапазона
+void fillHistograms(BoostContext& ctx, RowRange range, std::vector<GradientSum>& histogram) {
+    histogram.assign(ctx.histogramSize, {});
+
+    auto fillAttribute = [&](std::size_t k, unsigned) {
+        const int attr = ctx.attrs[k];
+        GradientSum* hist = histogram.data() + ctx.offsets[attr];
+        for (std::size_t i = range.begin; i < range.end; ++i) {
+            const std::size_t row = ctx.rows[i];
+            GradientSum& bin = hist[binOf(ctx.data, attr, row)];
+            bin.grad += ctx.grad[row];
+            bin.hess += ctx.hess[row];
+            bin.count += 1.0;
+        }
+    };
+
+    if (ctx.pool && ctx.attrs.size() > 1 && range.size() >= kParallelHistogramRows) {
+        ctx.pool->parallelFor(ctx.attrs.size(), fillAttribute);
+    } else {
+        for (std::size_t k = 0; k < ctx.attrs.size(); ++k) fillAttribute(k, 0);
+    }
+}
+
+// Вклад части узла в качество разбиения: G^2 / (H + lambda)
+double leafScore(const BoostContext& ctx, const GradientSum& sum) {
+    return sum.grad * sum.grad / (sum.hess + ctx.options.l2Regularization);
+}
+
+// Допустимы ли части разбиения по размеру и сумме гессианов
+bool validChildren(const BoostContext& ctx, const GradientSum& left, const GradientSum& right) {
+    const double minRows = static_cast<double>(std::max<std::size_t>(ctx.options.minRowsPerLeaf, 1));
+    return left.count >= minRows && right.count >= minRows &&
+           left.hess >= ctx.options.minChildHessian &&
+           right.hess >= ctx.options.minChildHessian;
+}
+
+// Лучшее разбиение по одному атрибуту (строки с пропуском в ветки не идут).
+// Числовой — проход по корзинам по порядку, категориальный — по значениям,
+// упорядоченным по G / (H + lambda), как в поиске двух групп CART
+void findAttributeSplit(const BoostContext& ctx, const std::vector<GradientSum>& histogram,
+                        int attr, BoostSplit& best) {
+    const std::size_t numBins = binCount(ctx.data, attr);
+    const GradientSum* hist = histogram.data() + ctx.offsets[attr];
+
+    GradientSum total;
+    for (std::size_t b = 0; b < numBins; ++b) total.add(hist[b]);
+    const double parentScore = leafScore(ctx, total);
+
+    std::vector<std::size_t> order;
+    if (ctx.data.isNumeric(attr)) {
+        order.resize(numBins);
+        for (std::size_t b = 0; b < numBins; ++b) order[b] = b;
+    } else {
+        for (std::size_t b = 0; b < numBins; ++b) {
+            if (hist[b].count > 0) order.push_back(b);
+        }
+        const double lambda = ctx.options.l2Regularization;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+            return hist[l].grad / (hist[l].hess + lambda) < hist[r].grad / (hist[r].hess + lambda);
+        });
+    }
+
+    GradientSum left;
+    std::size_t bestPrefix = 0;
+    double bestGain = best.gain;
+    for (std::size_t i = 0; i + 1 < order.size(); ++i) {
+        const GradientSum& bin = hist[order[i]];
+        left.add(bin);
+        if (bin.count == 0) continue;
+
+        GradientSum right = total;
+        right -= left;
+        if (!validChildren(ctx, left, right)) continue;
+
+        const double gain = leafScore(ctx, left) + leafScore(ctx, right) - parentScore;
+        if (gain > bestGain) {
+            bestGain = gain;
+            bestPrefix = i + 1;
+        }
+    }
+    if (bestPrefix == 0) return;
+
+    best.gain = bestGain;
+    best.attr = attr;
+    if (ctx.data.isNumeric(attr)) {
+        best.lastLeftBin = order[bestPrefix - 1];
+        best.leftCodes.clear();
+    } else {
+        best.leftCodes.assign(numBins, false);
+        for (std::size_t i = 0; i < bestPrefix; ++i) best.leftCodes[order[i]] = true;
+    }
+}
+
+// Раскладка строк узла: левая ветка, правая, затем строки с пропуском —
+// той же раскладкой подсчётом, что у построителя деревьев.
+// Возвращает конец левой и конец правой ветки
+std::pair<std::size_t, std::size_t> partitionRows(BoostContext& ctx, RowRange range,
+                                                  const BoostSplit& split) {
+    const std::size_t numBins = binCount(ctx.data, split.attr);
+    auto sideOf = [&](std::size_t row) -> std::size_t {
+        const std::size_t bin = binOf(ctx.data, split.attr, row);
+        if (bin == numBins) return 2;
+        const bool left = split.leftCodes.empty() ? bin <= split.lastLeftBin : split.leftCodes[bin];
+        return left ? 0 : 1;
+    };
+
+    const std::vector<std::size_t> offsets =
+        tree_builder_detail::groupOffsets(ctx.rows, range, 2, sideOf);
+    tree_builder_detail::scatterRows(ctx.rows, ctx.scratch, range, offsets, sideOf);
+    return {offsets[1], offsets[2]};
+}
+
+std::int32_t makeLeaf(BoostContext& ctx, const GradientSum& sum) {
+    FlatNode leaf;
+    leaf.attr = -1;
+    leaf.offset = static_cast<std::uint32_t>(ctx.tree.leafValues.size());
+    ctx.tree.leafValues.push_back(-sum.grad / (sum.hess + ctx.options.l2Regularization) *
+                                  ctx.options.learningRate);
+    ctx.tree.nodes.push_back(leaf);
+    return static_cast<std::int32_t>(ctx.tree.nodes.size() - 1);
+}
+
+// Рост узла в глубину; histogram — его гистограмма, если её дал родитель.
+// Возвращает индекс узла в ctx.tree.nodes
+std::int32_t growNode(BoostContext& ctx, RowRange range, std::size_t depth,
+                      std::vector<GradientSum> histogram) {
+    GradientSum sum;
+    for (std::size_t i = range.begin; i < range.end; ++i) {
+        const std::size_t row = ctx.rows[i];
+        sum.add({ctx.grad[row], ctx.hess[row], 1.0});
+    }
+
+    if (depth >= ctx.options.maxDepth ||
+        range.size() < 2 * std::max<std::size_t>(ctx.options.minRowsPerLeaf, 1)) {
+        return makeLeaf(ctx, sum);
+    }
+
+    if (histogram.empty()) fillHistograms(ctx, range, histogram);
+
+    // При равных выигрышах — атрибут, стоящий раньше
+    BoostSplit split;
+    for (int attr : ctx.attrs) findAttributeSplit(ctx, histogram, attr, split);
+    if (split.attr < 0) return makeLeaf(ctx, sum);
+
+    const auto [leftEnd, rightEnd] = partitionRows(ctx, range, split);
+    const RowRange left{range.begin, leftEnd};
+    const RowRange right{leftEnd, rightEnd};
+
+    // Гистограммы детей, как у построителя деревьев: меньший — проходом,
+    // больший — вычитанием (строки с пропуском лежат в хвосте range)
+    std::vector<std::vector<GradientSum>> childHistograms(2);
+    if (depth + 1 < ctx.options.maxDepth) {
+        childHistograms = tree_builder_detail::subtractChildHistograms(
+            range, {left, right}, std::move(histogram),
+            [&ctx](RowRange part, std::vector<GradientSum>& out) {
+                fillHistograms(ctx, part, out);
+            });
+    }
+    histogram = {};
+
+    const auto index = static_cast<std::int32_t>(ctx.tree.nodes.size());
+    FlatNode node;
+    node.attr = split.attr;
+    node.offset = static_cast<std::uint32_t>(ctx.tree.childTable.size());
+    node.numCodes = split.leftCodes.empty() ? kThresholdNode
+                                            : static_cast<std::uint32_t>(split.leftCodes.size());
+    ctx.tree.nodes.push_back(node);
+    ctx.tree.childTable.resize(ctx.tree.childTable.size() +
+                                   (split.leftCodes.empty() ? 2 : split.leftCodes.size()),
+                               -1);
+    if (split.leftCodes.empty()) {
+        ctx.tree.thresholds.resize(ctx.tree.nodes.size(), 0.0);
+        ctx.tree.thresholds[index] = ctx.data.binEdges[split.attr][split.lastLeftBin];
+    }
+
+    const std::int32_t leftChild = growNode(ctx, left, depth + 1, std::move(childHistograms[0]));
+    const std::int32_t rightChild = growNode(ctx, right, depth + 1, std::move(childHistograms[1]));
+
+    // Значения, которых не было в узле, идут вправо
+    std::int32_t* children = ctx.tree.childTable.data() + node.offset;
+    if (split.leftCodes.empty()) {
+        children[0] = leftChild;
+        children[1] = rightChild;
+    } else {
+        for (std::size_t code = 0; code < split.leftCodes.size(); ++code) {
+            children[code] = split.leftCodes[code] ? leftChild : rightChild;
+        }
+    }
+    return index;
+}
+
+// Дерево по строкам ctx.rows
+RegressionTree growTree(BoostContext& ctx) {
+    ctx.tree = RegressionTree{};
+    ctx.scratch.resize(ctx.rows.size());
+    growNode(ctx, {0, ctx.rows.size()}, 0, {});
+    if (!ctx.tree.thresholds.empty()) ctx.tree.thresholds.resize(ctx.tree.nodes.size(), 0.0);
+    return std::move(ctx.tree);
+}
+
+// Вероятности классов по счётам выходов модели
+void scoresToProbabilities(const BoostedModel& model, const double* scores, double* probs) {
+    if (model.numOutputs == 1) {
+        probs[1] = 1.0 / (1.0 + std::exp(-scores[0]));
+        probs[0] = 1.0 - probs[1];
+        return;
+    }
+    const double top = *std::max_element(scores, scores + model.numOutputs);
+    double total = 0.0;
+    for (std::size_t k = 0; k < model.numOutputs; ++k) {
+        probs[k] = std::exp(scores[k] - top);
+        total += probs[k];
+    }
+    for (std::size_t k = 0; k < model.numOutputs; ++k) probs[k] /= total;
+}
+
+// Класс с наибольшей вероятностью; при равенстве — меньшая по алфавиту метка
+std::int32_t bestClass(const BoostedModel& model, const double* probs) {
+    std::int32_t best = 0;
+    for (std::size_t c = 1; c < model.classNames.size(); ++c) {
+        if (probs[c] > probs[best] ||
+            (probs[c] == probs[best] && model.classNames[c] < model.classNames[best])) {
+            best = static_cast<std::int32_t>(c);
+        }
+    }
+    return best;
+}
+
+// Счёт строк [begin, end) по деревьям [firstTree, trees.size()):
+// scores[(row - begin) * numOutputs + k] += вклад деревьев выхода k.
+// Строки идут блоками, и каждое дерево проходит блок пакетным спуском
+// findFlatLeaves, как у classifyBatch для CompiledTree
+void addTreeScores(const BoostedModel& model, std::size_t firstTree,
+                   const EncodedDataset& data, std::size_t begin, std::size_t end,
+                   double* scores) {
+    std::int32_t leaves[kFlatBlockRows];
+    for (std::size_t first = begin; first < end; first += kFlatBlockRows) {
+        const std::size_t last = std::min(first + kFlatBlockRows, end);
+        for (std::size_t t = firstTree; t < model.trees.size(); ++t) {
+            const RegressionTree& tree = model.trees[t];
+            const std::size_t output = t % model.numOutputs;
+            findFlatLeaves(tree.nodes.data(), tree.childTable.data(), tree.thresholds.data(),
+                           data, first, last, leaves);
+            for (std::size_t row = first; row < last; ++row) {
+                const std::int32_t leaf = leaves[row - first];
+                if (leaf < 0) continue;
+                scores[(row - begin) * model.numOutputs + output] +=
+                    tree.leafValues[tree.nodes[leaf].offset];
+            }
+        }
+    }
+}
+
+// Выполнение body(begin, end) блоками строк — параллельно, если есть пул
+template <typename Body>
+void forRowBlocks(ThreadPool* pool, std::size_t numRows, Body body) {
+    const std::size_t numBlocks = (numRows + kScoreBlockRows - 1) / kScoreBlockRows;
+    auto runBlock = [&](std::size_t block, unsigned) {
+        const std::size_t begin = block * kScoreBlockRows;
+        body(begin, std::min(begin + kScoreBlockRows, numRows));
+    };
+    if (pool && numBlocks > 1) {
+        pool->parallelFor(numBlocks, runBlock);
+    } else {
+        for (std::size_t b = 0; b < numBlocks; ++b) runBlock(b, 0);
+    }
+}
+
+// Средние логистические (softmax) потери по строкам с известным классом
+double logLoss(const BoostedModel& model, const EncodedDataset& data,
+               const std::vector<double>& scores) {
+    const std::size_t numClasses = model.classNames.size();
+    std::vector<double> probs(numClasses);
+    double loss = 0.0;
+    std::size_t counted = 0;
+    for (std::size_t row = 0; row < data.numRows; ++row) {
+        const Code label = data.label(row);
+        if (label >= numClasses) continue;
+        scoresToProbabilities(model, scores.data() + row * model.numOutputs, probs.data());
+        loss -= std::log(std::max(probs[label], 1e-15));
+        ++counted;
+    }
+    return counted ? loss / static_cast<double>(counted) : 0.0;
+}
+
+// Проверочная выборка закодирована словарями train: те же атрибуты и
+// типы, словари атрибутов и классов совпадают с обучающими
+bool sameEncoding(const EncodedDataset& train, const EncodedDataset& other) {
+    if (other.attrNames != train.attrNames) return false;
+    for (std::size_t a = 0; a < train.numAttrs(); ++a) {
+        const int attr = static_cast<int>(a);
+        if (other.isNumeric(attr) != train.isNumeric(attr) ||
+            other.attrDicts[a].values != train.attrDicts[a].values) {
+            return false;
+        }
+    }
+    return other.labelDict.values == train.labelDict.values;
+}
+
+} // namespace
+
+bool trainGradientBoosting(const EncodedDataset& train,
+                           const std::vector<int>& availableAttributes,
+                           const BoostingOptions& options,
+                           BoostedModel& model,
+                           const EncodedDataset* validation) {
+    const std::size_t numClasses = train.labelDict.size();
+    if (train.numRows == 0 || numClasses < 2) {
+        std::cerr << "Для бустинга нужна выборка хотя бы с двумя классами\n";
+        return false;
+    }
+    for (int attr : availableAttributes) {
+        if (train.isNumeric(attr) && !train.isBinned(attr)) {
+            std::cerr << "Числовой атрибут " << train.attrNames[attr]
+                      << " не разбит на корзины (binNumericAttributes)\n";
+            return false;
+        }
+    }
+    for (std::size_t row = 0; row < train.numRows; ++row) {
+        if (train.label(row) >= numClasses) {
+            std::cerr << "Класс строки " << row << " обучающей выборки не входит в её словарь\n";
+            return false;
+        }
+    }
+    if (validation && !sameEncoding(train, *validation)) {
+        std::cerr << "Проверочная выборка закодирована не словарями обучающей "
+                     "(encodeDataset с образцом или CsvLoadOptions::dictionaries)\n";
+        return false;
+    }
+
+    model = BoostedModel{};
+    model.classNames = train.labelDict.values;
+    model.numOutputs = numClasses == 2 ? 1 : numClasses;
+    const std::size_t numOutputs = model.numOutputs;
+
+    // Начальный счёт — логарифм шансов (доли) классов
+    std::vector<double> freq(numClasses, 0.0);
+    for (std::size_t row = 0; row < train.numRows; ++row) freq[train.label(row)] += 1.0;
+    for (double& f : freq) f = std::max(f, 1.0) / static_cast<double>(train.numRows);
+    if (numOutputs == 1) {
+        model.baseScores = {std::log(freq[1] / std::max(freq[0], 1e-15))};
+    } else {
+        for (double f : freq) model.baseScores.push_back(std::log(f));
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (options.numThreads != 1) pool = std::make_unique<ThreadPool>(options.numThreads);
+
+    std::vector<double> scores(train.numRows * numOutputs);
+    for (std::size_t row = 0; row < train.numRows; ++row) {
+        std::copy(model.baseScores.begin(), model.baseScores.end(),
+                  scores.begin() + row * numOutputs);
+    }
+    std::vector<double> validScores;
+    if (validation) {
+        validScores.resize(validation->numRows * numOutputs);
+        for (std::size_t row = 0; row < validation->numRows; ++row) {
+            std::copy(model.baseScores.begin(), model.baseScores.end(),
+                      validScores.begin() + row * numOutputs);
+        }
+    }
+
+    BoostContext ctx(train, options);
+    ctx.pool = pool.get();
+    std::vector<double> probs(train.numRows * numClasses);
+    std::vector<double> grad(train.numRows);
+    std::vector<double> hess(train.numRows);
+    ctx.grad = grad.data();
+    ctx.hess = hess.data();
+
+    double bestLoss = std::numeric_limits<double>::infinity();
+    std::size_t bestRounds = 0;
+
+    for (std::size_t round = 0; round < options.numRounds; ++round) {
+        const std::uint64_t roundSeed = tree_builder_detail::mixSeed(options.seed, round);
+
+        // Атрибуты раунда и их места в гистограмме
+        ctx.attrs = availableAttributes;
+        const auto perRound = static_cast<std::size_t>(
+            std::llround(options.columnSampleRate * static_cast<double>(ctx.attrs.size())));
+        if (perRound >= 1 && perRound < ctx.attrs.size()) {
+            ctx.attrs = tree_builder_detail::sampleAttributes(ctx.attrs, perRound, roundSeed);
+        }
+        ctx.offsets.assign(train.numAttrs(), 0);
+        ctx.histogramSize = 0;
+        for (int attr : ctx.attrs) {
+            ctx.offsets[attr] = ctx.histogramSize;
+            ctx.histogramSize += binCount(train, attr) + 1;
+        }
+
+        forRowBlocks(ctx.pool, train.numRows, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t row = begin; row < end; ++row) {
+                scoresToProbabilities(model, scores.data() + row * numOutputs,
+                                      probs.data() + row * numClasses);
+            }
+        });
+
+        const std::size_t firstTree = model.trees.size();
+        for (std::size_t output = 0; output < numOutputs; ++output) {
+            // Градиенты и гессианы потерь по счёту выхода
+            const std::size_t cls = numOutputs == 1 ? 1 : output;
+            forRowBlocks(ctx.pool, train.numRows, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t row = begin; row < end; ++row) {
+                    const double p = probs[row * numClasses + cls];
+                    grad[row] = p - (train.label(row) == cls ? 1.0 : 0.0);
+                    hess[row] = std::max(p * (1.0 - p), 1e-16);
+                }
+            });
+
+            // Подвыборка строк дерева
+            ctx.rows.clear();
+            if (options.rowSampleRate >= 1.0) {
+                ctx.rows.resize(train.numRows);
+                for (std::size_t row = 0; row < train.numRows; ++row) ctx.rows[row] = row;
+            } else {
+                std::mt19937_64 rng(tree_builder_detail::mixSeed(roundSeed, output));
+                std::uniform_real_distribution<double> uniform(0.0, 1.0);
+                for (std::size_t row = 0; row < train.numRows; ++row) {
+                    if (uniform(rng) < options.rowSampleRate) ctx.rows.push_back(row);
+                }
+            }
+
+            model.trees.push_back(growTree(ctx));
+        }
+
+        // Новые деревья добавляются к счётам обучающей и проверочной выборок
+        forRowBlocks(ctx.pool, train.numRows, [&](std::size_t begin, std::size_t end) {
+            addTreeScores(model, firstTree, train, begin, end,
+                          scores.data() + begin * numOutputs);
+        });
+        if (!validation) continue;
+
+        forRowBlocks(ctx.pool, validation->numRows, [&](std::size_t begin, std::size_t end) {
+            addTreeScores(model, firstTree, *validation, begin, end,
+                          validScores.data() + begin * numOutputs);
+        });
+        const double loss = logLoss(model, *validation, validScores);
+        model.validationLoss.push_back(loss);
+        if (loss < bestLoss) {
+            bestLoss = loss;
+            bestRounds = round + 1;
+        } else if (options.earlyStoppingRounds != 0 &&
+                   round + 1 - bestRounds >= options.earlyStoppingRounds) {
+            break;
+        }
+    }
+
+    // Ранняя остановка: модель — до лучшего раунда на проверочной выборке
+    if (validation && options.earlyStoppingRounds != 0) {
+        model.trees.resize(bestRounds * numOutputs);
+    }
+    return true;
+}
+
+std::vector<double> classProbabilities(const BoostedModel& model,
+                                       const EncodedDataset& data,
+                                       std::size_t row) {
+    std::vector<double> scores = model.baseScores;
+    addTreeScores(model, 0, data, row, row + 1, scores.data());
+    std::vector<double> probs(model.classNames.size());
+    scoresToProbabilities(model, scores.data(), probs.data());
+    return probs;
+}
+
+std::string classify(const BoostedModel& model,
+                     const EncodedDataset& data,
+                     std::size_t row) {
+    if (model.classNames.empty()) return "Неизвестно";
+    const std::vector<double> probs = classProbabilities(model, data, row);
+    return model.classNames[bestClass(model, probs.data())];
+}
+
+void classifyBatch(const BoostedModel& model,
+                   const EncodedDataset& batch,
+                   std::int32_t* out,
+                   unsigned numThreads) {
+    if (model.classNames.empty()) {
+        std::fill(out, out + batch.numRows, -1);
+        return;
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (numThreads != 1) pool = std::make_unique<ThreadPool>(numThreads);
+
+    const std::size_t numOutputs = model.numOutputs;
+    forRowBlocks(pool.get(), batch.numRows, [&](std::size_t begin, std::size_t end) {
+        std::vector<double> scores((end - begin) * numOutputs);
+        for (std::size_t row = begin; row < end; ++row) {
+            std::copy(model.baseScores.begin(), model.baseScores.end(),
+                      scores.begin() + (row - begin) * numOutputs);
+        }
+        addTreeScores(model, 0, batch, begin, end, scores.data());
+
+        std::vector<double> probs(model.classNames.size());
+        for (std::size_t row = begin; row < end; ++row) {
+            scoresToProbabilities(model, scores.data() + (row - begin) * numOutputs, probs.data());
+            out[row] = bestClass(model, probs.data());
+        }
+    });
+}
@@ -0,0 +1,177 @@
+#include "hoeffding_tree.h"
+#include "count_tree.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Узел потокового дерева. Внутренний узел помнит частоты классов
+// (ответ для значений, которых он ещё не видел), лист — ещё и таблицы
+// частот по каждому доступному атрибуту
+struct HoeffdingTree::Node {
+    int attr = -1;                               // -1 — лист
+    std::vector<std::unique_ptr<Node>> children; // код значения attr -> поддерево
+    count_tree_detail::ClassCounts classCounts;  // частоты классов в узле
+    std::vector<int> available;                  // атрибуты, которые ещё можно выбрать
+
+    // Только у листа: для available[k] частоты классов по коду значения
+    // (counts[k][code][class]) и у примеров без значения (missing[k][class])
+    std::vector<std::vector<count_tree_detail::ClassCounts>> counts;
+    std::vector<count_tree_detail::ClassCounts> missing;
+    std::size_t seen = 0;       // примеров, дошедших до листа
+    std::size_t sinceCheck = 0; // примеров с последней попытки разбиения
+};
+
+using count_tree_detail::addToTable;
+using count_tree_detail::fillTable;
+using count_tree_detail::increment;
+using count_tree_detail::isPure;
+using count_tree_detail::majorityClass;
+using count_tree_detail::snapshotTree;
+
+// Пустой лист с таблицами под каждый доступный атрибут
+std::unique_ptr<HoeffdingTree::Node> HoeffdingTree::makeLeaf(std::vector<int> available) {
+    auto leaf = std::make_unique<Node>();
+    leaf->counts.resize(available.size());
+    leaf->missing.resize(available.size());
+    leaf->available = std::move(available);
+    return leaf;
+}
+
+HoeffdingTree::HoeffdingTree(std::vector<std::string> attrNames,
+                             const HoeffdingOptions& options)
+    : attrNames_(std::move(attrNames)),
+      options_(options),
+      attrDicts_(attrNames_.size()) {
+    std::vector<int> all(attrNames_.size());
+    for (std::size_t a = 0; a < all.size(); ++a) all[a] = static_cast<int>(a);
+    root_ = makeLeaf(std::move(all));
+}
+
+HoeffdingTree::~HoeffdingTree() = default;
+HoeffdingTree::HoeffdingTree(HoeffdingTree&&) noexcept = default;
+HoeffdingTree& HoeffdingTree::operator=(HoeffdingTree&&) noexcept = default;
+
+void HoeffdingTree::learn(const std::vector<Example>& batch) {
+    for (const auto& example : batch) learn(example);
+}
+
+void HoeffdingTree::learn(const Example& example) {
+    auto codeOf = [&](int attr) {
+        return static_cast<std::size_t>(attr) < example.attrs.size()
+                   ? attrDicts_[attr].encode(example.attrs[attr])
+                   : kUnknownCode;
+    };
+    const Code label = labelDict_.encode(example.label);
+    ++examplesSeen_;
+
+    // Спуск до листа; новое значение в узле получает свой пустой лист
+    Node* node = root_.get();
+    while (node->attr >= 0) {
+        increment(node->classCounts, label);
+        const Code value = codeOf(node->attr);
+        if (value == kUnknownCode) return; // без значения пример дальше не идёт
+
+        if (node->children.size() <= value) node->children.resize(value + 1);
+        if (!node->children[value]) {
+            std::vector<int> available = node->available;
+            available.erase(std::find(available.begin(), available.end(), node->attr));
+            node->children[value] = makeLeaf(std::move(available));
+            ++numNodes_;
+            ++numLeaves_;
+        }
+        node = node->children[value].get();
+    }
+
+    // Лист: частоты классов и таблицы по атрибутам
+    increment(node->classCounts, label);
+    for (std::size_t k = 0; k < node->available.size(); ++k) {
+        addToTable(node->counts[k], node->missing[k], codeOf(node->available[k]), label);
+    }
+    ++node->seen;
+
+    if (++node->sinceCheck >= options_.gracePeriod) {
+        node->sinceCheck = 0;
+        trySplit(*node);
+    }
+}
+
+void HoeffdingTree::trySplit(Node& leaf) {
+    const std::size_t numClasses = labelDict_.size();
+    if (isPure(leaf.classCounts) || leaf.available.empty()) return;
+
+    // Прирост информации каждого атрибута по таблицам листа;
+    // «второй» начинается с нуля — это вариант не делить лист вовсе
+    ContingencyTable table;
+    double bestGain = 0.0;
+    double secondGain = 0.0;
+    int best = -1;
+    for (std::size_t k = 0; k < leaf.available.size(); ++k) {
+        fillTable(table, leaf.counts[k], leaf.missing[k], numClasses);
+        const double gain = informationGain(table);
+        if (gain > bestGain) {
+            secondGain = bestGain;
+            bestGain = gain;
+            best = static_cast<int>(k);
+        } else if (gain > secondGain) {
+            secondGain = gain;
+        }
+    }
+    if (best < 0) return;
+
+    // Граница Хёфдинга для прироста информации (размах — log2 числа классов)
+    const double range = std::log2(static_cast<double>(numClasses));
+    const double epsilon = std::sqrt(range * range * std::log(1.0 / options_.delta) /
+                                     (2.0 * static_cast<double>(leaf.seen)));
+    if (bestGain - secondGain <= epsilon && epsilon >= options_.tieThreshold) return;
+
+    // Лист становится внутренним узлом; дети начинают с частот своих
+    // значений, чтобы сразу отвечать на запросы
+    const int attr = leaf.available[best];
+    std::vector<int> childAvailable = leaf.available;
+    childAvailable.erase(childAvailable.begin() + best);
+
+    auto& byValue = leaf.counts[best];
+    leaf.children.resize(byValue.size());
+    for (std::size_t v = 0; v < byValue.size(); ++v) {
+        if (byValue[v].empty()) continue;
+        leaf.children[v] = makeLeaf(childAvailable);
+        leaf.children[v]->classCounts = std::move(byValue[v]);
+        ++numNodes_;
+        ++numLeaves_;
+    }
+    --numLeaves_;
+
+    leaf.attr = attr;
+    leaf.counts = {};
+    leaf.missing = {};
+}
+
+std::string HoeffdingTree::predict(const Example& example) const {
+    const Node* node = root_.get();
+    Code answer = majorityClass(node->classCounts, labelDict_);
+    while (node->attr >= 0) {
+        if (static_cast<std::size_t>(node->attr) >= example.attrs.size()) break;
+        const Code value = attrDicts_[node->attr].find(example.attrs[node->attr]);
+        if (value >= node->children.size() || !node->children[value]) break;
+        node = node->children[value].get();
+
+        const Code cls = majorityClass(node->classCounts, labelDict_);
+        if (cls != kUnknownCode) answer = cls;
+    }
+    return answer == kUnknownCode ? std::string("Неизвестно") : labelDict_.values[answer];
+}
+
+DecisionTree HoeffdingTree::snapshot() const {
+    // Как predict: значение, которого узел не видел, получает его класс
+    auto nodeClass = [this](const Node& node) {
+        return majorityClass(node.classCounts, labelDict_);
+    };
+    return snapshotTree(
+        *root_, attrNames_, attrDicts_, labelDict_, nodeClass,
+        [this](const Node& node) { return attrDicts_[node.attr].size(); },
+        nodeClass);
+}
+
+std::string classify(const HoeffdingTree& tree, const Example& example) {
+    return tree.predict(example);
+}
@@ -1,163 +1,71 @@
 #include "id3.h"
+#include "tree_builder.h"
 
 #include <algorithm>
 #include <cmath>
-#include <map>
-#include <numeric>
-#include <stdexcept>
-
-// Подсчёт частот классов
-static std::map<std::string, int> countLabels(const std::vector<Example>& data) {
-    std::map<std::string, int> freq;
-    for (const auto& ex : data) {
-        ++freq[ex.label];
-    }
-    return freq;
-}
+#include <limits>
 
-static bool isPure(const std::vector<Example>& data) {
-    if (data.empty()) return true;
-    const std::string& firstLabel = data.front().label;
-    for (const auto& ex : data) {
-        if (ex.label != firstLabel) return false;
-    }
-    return true;
+DecisionTree buildID3(const EncodedDataset& data,
+                      const std::vector<int>& availableAttributes,
+                      const TreeOptions& options) {
+    return buildTree<InformationGainCriterion>(data, availableAttributes, options);
 }
 
-static std::string majorityClass(const std::vector<Example>& data) {
-    auto freq = countLabels(data);
-    if (freq.empty()) {
-        return {};
-    }
-    return std::max_element(
-               freq.begin(), freq.end(),
-               [](const auto& a, const auto& b) {
-                   return a.second < b.second;
-               })
-        ->first;
+DecisionTree buildID3(const std::vector<Example>& data,
+                      const std::vector<std::string>& attrNames,
+                      const std::vector<int>& availableAttributes) {
+    return buildID3(encodeDataset(data, attrNames), availableAttributes);
 }
 
-static double entropy(const std::vector<Example>& data) {
-    auto freq = countLabels(data);
-    if (freq.empty()) return 0.0;
-
-    const double n = static_cast<double>(data.size());
-    double h = 0.0;
-    for (const auto& [label, count] : freq) {
-        double p = count / n;
-        if (p > 0.0) {
-            h -= p * std::log2(p);
-        }
-    }
-    return h;
+DecisionTree buildC45(const EncodedDataset& data,
+                      const std::vector<int>& availableAttributes,
+                      const TreeOptions& options) {
+    return buildTree<GainRatioCriterion>(data, availableAttributes, options);
 }
 
-// Разбиение выборки по значению одного атрибута
-static std::map<std::string, std::vector<Example>>
-splitByAttribute(const std::vector<Example>& data, int attrIndex) {
-    std::map<std::string, std::vector<Example>> subsets;
-    for (const auto& ex : data) {
-        if (attrIndex < 0 || attrIndex >= static_cast<int>(ex.attrs.size())) continue;
-        subsets[ex.attrs[attrIndex]].push_back(ex);
-    }
-    return subsets;
+DecisionTree buildC45(const std::vector<Example>& data,
+                      const std::vector<std::string>& attrNames,
+                      const std::vector<int>& availableAttributes) {
+    return buildC45(encodeDataset(data, attrNames), availableAttributes);
 }
 
-// Информационный выигрыш
-static double informationGain(const std::vector<Example>& data, int attrIndex) {
-    double baseEntropy = entropy(data);
-    auto subsets = splitByAttribute(data, attrIndex);
-    if (subsets.empty()) return 0.0;
-
-    double n = static_cast<double>(data.size());
-    double condEntropy = 0.0;
-
-    for (const auto& [value, subset] : subsets) {
-        double w = static_cast<double>(subset.size()) / n;
-        condEntropy += w * entropy(subset);
-    }
-
-    return baseEntropy - condEntropy;
+DecisionTree buildCART(const EncodedDataset& data,
+                       const std::vector<int>& availableAttributes,
+                       const TreeOptions& options) {
+    return buildTree<BinaryGiniCriterion>(data, availableAttributes, options);
 }
 
-TreeNode* buildID3(const std::vector<Example>& data,
-                   const std::vector<std::string>& attrNames,
-                   const std::vector<int>& availableAttributes) {
-    // Если выборка пустая — возвращаем пустой лист (на практике такого быть не должно)
-    if (data.empty()) {
-        auto* node = new TreeNode();
-        node->isLeaf = true;
-        node->label = "Нет данных";
-        return node;
-    }
-
-    // Если все объекты одного класса — лист с этим классом
-    if (isPure(data)) {
-        auto* node = new TreeNode();
-        node->isLeaf = true;
-        node->label = data.front().label;
-        return node;
-    }
-
-    // Если атрибутов не осталось — лист с наиболее частым классом
-    if (availableAttributes.empty()) {
-        auto* node = new TreeNode();
-        node->isLeaf = true;
-        node->label = majorityClass(data);
-        return node;
-    }
-
-    // Выбираем атрибут с максимальным информационным выигрышем
-    double bestGain = -1.0;
-    int bestAttr = -1;
-
-    for (int attrIndex : availableAttributes) {
-        double gain = informationGain(data, attrIndex);
-        if (gain > bestGain) {
-            bestGain = gain;
-            bestAttr = attrIndex;
-        }
-    }
-
-    if (bestAttr == -1) {
-        // На всякий случай — fallback: лист с majority class
-        auto* node = new TreeNode();
-        node->isLeaf = true;
-        node->label = majorityClass(data);
-        return node;
-    }
-
-    auto* node = new TreeNode();
-    node->isLeaf = false;
-    node->label = attrNames[bestAttr]; // имя признака
-
-    auto subsets = splitByAttribute(data, bestAttr);
+DecisionTree buildCART(const std::vector<Example>& data,
+                       const std::vector<std::string>& attrNames,
+                       const std::vector<int>& availableAttributes) {
+    return buildCART(encodeDataset(data, attrNames), availableAttributes);
+}
 
-    // Новый список доступных атрибутов (без bestAttr)
-    std::vector<int> newAvailable;
-    newAvailable.reserve(availableAttributes.size() - 1);
-    for (int idx : availableAttributes) {
-        if (idx != bestAttr) newAvailable.push_back(idx);
-    }
+DecisionTree buildCHAID(const EncodedDataset& data,
+                        const std::vector<int>& availableAttributes,
+                        const TreeOptions& options) {
+    return buildTree<ChaidCriterion>(data, availableAttributes, options);
+}
 
-    // Строим поддеревья для каждого значения атрибута
-    for (const auto& [value, subset] : subsets) {
-        if (subset.empty()) {
-            auto* child = new TreeNode();
-            child->isLeaf = true;
-            child->label = majorityClass(data);
-            node->children[value] = child;
-        } else {
-            node->children[value] = buildID3(subset, attrNames, newAvailable);
-        }
-    }
+DecisionTree buildCHAID(const std::vector<Example>& data,
+                        const std::vector<std::string>& attrNames,
+                        const std::vector<int>& availableAttributes) {
+    return buildCHAID(encodeDataset(data, attrNames), availableAttributes);
+}
 
-    return node;
+const TreeNode* TreeNode::child(std::string_view value) const {
+    // Ветки упорядочены по значению — двоичный поиск
+    const TreeEdge* end = edges + numEdges;
+    const TreeEdge* it = std::lower_bound(
+        static_cast<const TreeEdge*>(edges), end, value,
+        [](const TreeEdge& edge, std::string_view v) { return edge.value < v; });
+    if (it == end || it->value != value) return nullptr;
+    return it->child;
 }
 
 // Поиск индекса атрибута по имени
 static int findAttributeIndex(const std::vector<std::string>& attrNames,
-                              const std::string& name) {
+                              std::string_view name) {
     for (std::size_t i = 0; i < attrNames.size(); ++i) {
         if (attrNames[i] == name) return static_cast<int>(i);
     }
@@ -170,31 +78,83 @@ std::string classify(const TreeNode* root,
     const TreeNode* node = root;
 
     while (node && !node->isLeaf) {
-        int attrIndex = findAttributeIndex(attrNames, node->label);
+        int attrIndex = node->attrIndex >= 0
+                            ? node->attrIndex
+                            : findAttributeIndex(attrNames, node->label);
         if (attrIndex == -1 ||
             attrIndex >= static_cast<int>(example.attrs.size())) {
             // не нашли атрибут — возвращаем majority class "по умолчанию"
             return "Неизвестно";
         }
 
-        const std::string& val = example.attrs[attrIndex];
-        auto it = node->children.find(val);
-        if (it == node->children.end()) {
+        const TreeNode* next = nullptr;
+        if (node->numeric) {
+            // Числовой узел: сравнение с порогом, не число — неизвестно
+            const double value = parseNumber(example.attrs[attrIndex]);
+            if (!std::isnan(value)) next = node->codeChildren[value > node->threshold];
+        } else {
+            next = node->child(example.attrs[attrIndex]);
+        }
+        if (!next) {
             // нет такого значения в дереве
             return "Неизвестно";
         }
 
-        node = it->second;
+        node = next;
     }
 
     if (!node) return "Неизвестно";
-    return node->label;
+    return std::string(node->label);
 }
 
-void freeTree(TreeNode* root) {
-    if (!root) return;
-    for (auto& [value, child] : root->children) {
-        freeTree(child);
+// Спуск по кодам: getCode(attrIndex) возвращает код значения атрибута,
+// getNumber(attrIndex) — значение числового атрибута (NaN — неизвестно)
+template <typename GetCode, typename GetNumber>
+static std::string classifyByCodes(const TreeNode* node, GetCode getCode,
+                                   GetNumber getNumber) {
+    while (node && !node->isLeaf) {
+        if (node->numeric) {
+            const double number = getNumber(node->attrIndex);
+            if (std::isnan(number)) return "Неизвестно";
+            node = node->codeChildren[number > node->threshold];
+            continue;
+        }
+        const Code value = getCode(node->attrIndex);
+        if (value >= node->numCodes || !node->codeChildren[value]) {
+            // нет такого значения в дереве
+            return "Неизвестно";
+        }
+        node = node->codeChildren[value];
     }
-    delete root;
+
+    if (!node) return "Неизвестно";
+    return std::string(node->label);
+}
+
+std::string classify(const TreeNode* root,
+                     const EncodedDataset& data,
+                     std::size_t row) {
+    auto inRange = [&](int attr) {
+        return attr >= 0 && attr < static_cast<int>(data.numAttrs());
+    };
+    return classifyByCodes(
+        root,
+        [&](int attr) { return inRange(attr) ? data.code(row, attr) : kUnknownCode; },
+        [&](int attr) {
+            return inRange(attr) && data.isNumeric(attr)
+                       ? data.number(row, attr)
+                       : std::numeric_limits<double>::quiet_NaN();
+        });
+}
+
+std::string classify(const TreeNode* root,
+                     const std::vector<Code>& encodedExample) {
+    return classifyByCodes(
+        root,
+        [&](int attr) {
+            return attr >= 0 && attr < static_cast<int>(encodedExample.size())
+                       ? encodedExample[attr]
+                       : kUnknownCode;
+        },
+        [](int) { return std::numeric_limits<double>::quiet_NaN(); });
 }
@@ -0,0 +1,231 @@
+#include "incremental_id3.h"
+#include "count_tree.h"
+
+#include <limits>
+
+// Узел дерева. Внутренний узел хранит таблицы частот по всем своим
+// доступным атрибутам и строки с пропущенным значением своего атрибута
+// (в ветки они не попадают, но нужны, если узел придётся перестроить);
+// лист — все свои строки
+struct IncrementalID3::Node {
+    int attr = -1;                           // -1 — лист
+    Code classCode = kUnknownCode;           // класс листа
+    std::vector<int> available;              // атрибуты, из которых выбирает узел
+    count_tree_detail::ClassCounts classCounts; // частоты классов в узле
+    std::vector<std::size_t> rows;
+
+    // Только у внутреннего узла: для available[k] частоты классов по коду
+    // значения (counts[k][code][class]) и у строк без значения (missing[k][class])
+    std::vector<std::vector<count_tree_detail::ClassCounts>> counts;
+    std::vector<count_tree_detail::ClassCounts> missing;
+    std::vector<std::unique_ptr<Node>> children; // код значения attr -> поддерево
+
+    bool dirty = false; // узел получил строки после последнего обновления
+};
+
+using count_tree_detail::addToTable;
+using count_tree_detail::fillTable;
+using count_tree_detail::increment;
+using count_tree_detail::isPure;
+using count_tree_detail::majorityClass;
+using count_tree_detail::snapshotTree;
+
+IncrementalID3::IncrementalID3(std::vector<std::string> attrNames,
+                               std::vector<int> availableAttributes)
+    : available_(std::move(availableAttributes)) {
+    data_.attrDicts.resize(attrNames.size());
+    data_.columns.resize(attrNames.size());
+    data_.attrNames = std::move(attrNames);
+    root_ = build({}, available_);
+}
+
+IncrementalID3::~IncrementalID3() = default;
+IncrementalID3::IncrementalID3(IncrementalID3&&) noexcept = default;
+IncrementalID3& IncrementalID3::operator=(IncrementalID3&&) noexcept = default;
+
+void IncrementalID3::fillTables(Node& node, std::size_t row) {
+    const Code label = data_.label(row);
+    for (std::size_t k = 0; k < node.available.size(); ++k) {
+        addToTable(node.counts[k], node.missing[k], data_.code(row, node.available[k]), label);
+    }
+}
+
+// Лучший атрибут по таблицам узла — те же таблицы сопряжённости и то же
+// правило, что в chooseBestAttribute: максимум прироста информации,
+// при равенстве — атрибут, стоящий раньше в available
+int IncrementalID3::bestAttribute(const Node& node) const {
+    const std::size_t numClasses = data_.labelDict.size();
+    ContingencyTable table;
+    double bestGain = -std::numeric_limits<double>::infinity();
+    int bestAttr = -1;
+    for (std::size_t k = 0; k < node.available.size(); ++k) {
+        fillTable(table, node.counts[k], node.missing[k], numClasses);
+        const double gain = informationGain(table);
+        if (gain > bestGain) {
+            bestGain = gain;
+            bestAttr = node.available[k];
+        }
+    }
+    return bestAttr;
+}
+
+// Поддерево по строкам rows — рекурсия buildID3 с сохранением таблиц
+std::unique_ptr<IncrementalID3::Node> IncrementalID3::build(std::vector<std::size_t> rows,
+                                                            std::vector<int> available) {
+    auto node = std::make_unique<Node>();
+    node->available = std::move(available);
+    for (std::size_t row : rows) increment(node->classCounts, data_.label(row));
+
+    // Пустой, чистый или без атрибутов — лист
+    if (rows.empty() || isPure(node->classCounts) || node->available.empty()) {
+        node->classCode = majorityClass(node->classCounts, data_.labelDict);
+        node->rows = std::move(rows);
+        return node;
+    }
+
+    node->counts.resize(node->available.size());
+    node->missing.resize(node->available.size());
+    for (std::size_t row : rows) fillTables(*node, row);
+    node->attr = bestAttribute(*node);
+
+    // Строки по веткам; строки без значения остаются в узле
+    std::vector<std::vector<std::size_t>> parts(data_.attrDicts[node->attr].size());
+    for (std::size_t row : rows) {
+        const Code value = data_.code(row, node->attr);
+        if (value == kUnknownCode) {
+            node->rows.push_back(row);
+        } else {
+            parts[value].push_back(row);
+        }
+    }
+
+    std::vector<int> childAvailable;
+    childAvailable.reserve(node->available.size() - 1);
+    for (int idx : node->available) {
+        if (idx != node->attr) childAvailable.push_back(idx);
+    }
+
+    node->children.resize(parts.size());
+    for (std::size_t code = 0; code < parts.size(); ++code) {
+        if (parts[code].empty()) continue;
+        node->children[code] = build(std::move(parts[code]), childAvailable);
+    }
+    return node;
+}
+
+void IncrementalID3::gatherRows(Node& node, std::vector<std::size_t>& rows) const {
+    rows.insert(rows.end(), node.rows.begin(), node.rows.end());
+    for (auto& child : node.children) {
+        if (child) gatherRows(*child, rows);
+    }
+}
+
+// Проверка узла, получившего строки: лист пересчитывает класс или
+// разворачивается в поддерево, внутренний узел со сменившимся лучшим
+// атрибутом перестраивается целиком, иначе проверяются его дети
+void IncrementalID3::refresh(std::unique_ptr<Node>& slot) {
+    Node& node = *slot;
+    if (!node.dirty) return;
+    node.dirty = false;
+
+    if (node.attr < 0) {
+        if (isPure(node.classCounts) || node.available.empty()) {
+            node.classCode = majorityClass(node.classCounts, data_.labelDict);
+            return;
+        }
+    } else if (bestAttribute(node) == node.attr) {
+        for (auto& child : node.children) {
+            if (child) refresh(child);
+        }
+        return;
+    }
+
+    std::vector<std::size_t> rows;
+    gatherRows(node, rows);
+    rebuiltRows_ += rows.size();
+    slot = build(std::move(rows), std::move(node.available));
+}
+
+void IncrementalID3::insert(const Example& example) {
+    insert(std::vector<Example>{example});
+}
+
+void IncrementalID3::insert(const std::vector<Example>& batch) {
+    rebuiltRows_ = 0;
+
+    // Новые строки кодируются так же, как в encodeDataset: словари
+    // пополняются в порядке поступления примеров
+    const std::size_t first = data_.numRows;
+    for (const auto& example : batch) {
+        for (std::size_t a = 0; a < data_.numAttrs(); ++a) {
+            data_.columns[a].push_back(a < example.attrs.size()
+                                           ? data_.attrDicts[a].encode(example.attrs[a])
+                                           : kUnknownCode);
+        }
+        data_.labels.push_back(data_.labelDict.encode(example.label));
+    }
+    data_.numRows += batch.size();
+
+    // Спуск каждой новой строки: счётчики узлов на её пути. Значение,
+    // которого у узла ещё не было, получает новый пустой лист
+    for (std::size_t row = first; row < data_.numRows; ++row) {
+        Node* node = root_.get();
+        while (true) {
+            node->dirty = true;
+            increment(node->classCounts, data_.label(row));
+            if (node->attr < 0) {
+                node->rows.push_back(row);
+                break;
+            }
+
+            fillTables(*node, row);
+            const Code value = data_.code(row, node->attr);
+            if (value == kUnknownCode) {
+                node->rows.push_back(row);
+                break;
+            }
+            if (node->children.size() <= value) node->children.resize(value + 1);
+            if (!node->children[value]) {
+                std::vector<int> available;
+                for (int idx : node->available) {
+                    if (idx != node->attr) available.push_back(idx);
+                }
+                node->children[value] = std::make_unique<Node>();
+                node->children[value]->available = std::move(available);
+            }
+            node = node->children[value].get();
+        }
+    }
+
+    refresh(root_);
+}
+
+std::string IncrementalID3::predict(const Example& example) const {
+    const Node* node = root_.get();
+    while (node->attr >= 0) {
+        const std::size_t attr = static_cast<std::size_t>(node->attr);
+        const Code value = attr < example.attrs.size()
+                               ? data_.attrDicts[attr].find(example.attrs[attr])
+                               : kUnknownCode;
+        if (value >= node->children.size() || !node->children[value]) {
+            // нет такого значения в дереве
+            return "Неизвестно";
+        }
+        node = node->children[value].get();
+    }
+    return node->classCode == kUnknownCode ? std::string("Нет данных")
+                                           : data_.labelDict.values[node->classCode];
+}
+
+// Как у buildID3: у внутреннего узла таблица детей по всему словарю атрибута
+DecisionTree IncrementalID3::snapshot() const {
+    return snapshotTree(
+        *root_, data_.attrNames, data_.attrDicts, data_.labelDict,
+        [](const Node& leaf) { return leaf.classCode; },
+        [this](const Node& node) { return data_.attrDicts[node.attr].size(); },
+        [](const Node&) { return kUnknownCode; });
+}
+
+std::string classify(const IncrementalID3& tree, const Example& example) {
+    return tree.predict(example);
+}
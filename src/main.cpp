@@ -22,10 +22,10 @@ int main() {
         availableAttributes.push_back(i);
     }
 
-    TreeNode* root = buildID3(data, attrNames, availableAttributes);
+    DecisionTree tree = buildID3(data, attrNames, availableAttributes);
 
     std::cout << "\nДерево решений (алгоритм ID3) для задачи выбора поставщика:\n";
-    printTree(root);
+    printTree(tree.root());
 
     // 4. Пример классификации нового поставщика
     Example newSupplier{
@@ -33,14 +33,12 @@ int main() {
         /* label: */ ""
     };
 
-    std::string decision = classify(root, newSupplier, attrNames);
+    std::string decision = classify(tree.root(), newSupplier, attrNames);
 
     std::cout << "\nКлассификация нового поставщика "
               << "(Цена=средняя, Качество=высокое, Срок=быстрая, Надёжность=высокая): "
               << decision << '\n';
 
-    // 5. Освобождение памяти
-    freeTree(root);
-
+    // 5. Память дерева освобождается вместе с tree
     return 0;
 }
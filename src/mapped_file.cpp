@@ -0,0 +1,99 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SEM13_HAVE_MMAP 1
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        isOpen_ = std::exchange(other.isOpen_, false);
+        mapped_ = std::exchange(other.mapped_, false);
+        buffer_ = std::move(other.buffer_);
+        if (!mapped_ && isOpen_) data_ = buffer_.data();
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& filename, Access access) {
+    close();
+
+#ifdef SEM13_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        switch (access) {
+        case Access::Sequential:
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            break;
+        case Access::Random:
+            ::madvise(p, size_, MADV_RANDOM);
+            break;
+        case Access::Normal:
+            break;
+        }
+        data_ = static_cast<const char*>(p);
+        mapped_ = true;
+    }
+    // Отображение остаётся действительным и после закрытия дескриптора
+    ::close(fd);
+#else
+    (void)access;
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    buffer_.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0, std::ios::beg);
+    in.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    if (!in) return false;
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+
+    isOpen_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef SEM13_HAVE_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    isOpen_ = false;
+    mapped_ = false;
+    buffer_.clear();
+}
@@ -0,0 +1,296 @@
+#include "model_io.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[4] = {'S', '1', '3', 'M'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kSectionAlignment = 8;
+
+struct ModelHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t numNodes;
+    std::uint32_t childTableSize;
+    std::uint32_t numAttrs;
+    std::uint32_t reserved;
+    std::uint64_t nodesOffset;
+    std::uint64_t childTableOffset;
+    std::uint64_t tablesOffset;
+};
+
+static_assert(sizeof(FlatNode) == 12, "FlatNode пишется в файл как есть");
+
+// Хеш строк, не зависящий от реализации стандартной библиотеки —
+// таблицы в файле должны читаться любой сборкой
+std::uint32_t fnv1a(std::string_view text) {
+    std::uint32_t h = 2166136261u;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void writePadding(std::ofstream& out) {
+    static const char zeros[kSectionAlignment] = {};
+    const auto pos = static_cast<std::size_t>(out.tellp());
+    const std::size_t pad = (kSectionAlignment - pos % kSectionAlignment) % kSectionAlignment;
+    out.write(zeros, static_cast<std::streamsize>(pad));
+}
+
+template <typename T>
+void writeRaw(std::ofstream& out, const T* data, std::size_t count) {
+    out.write(reinterpret_cast<const char*>(data),
+              static_cast<std::streamsize>(sizeof(T) * count));
+}
+
+// Строковая таблица: count, numSlots, offsets[count+1], slots[numSlots], bytes
+void writeStringTable(std::ofstream& out, const std::vector<std::string>& strings) {
+    writePadding(out);
+
+    const auto count = static_cast<std::uint32_t>(strings.size());
+    std::uint32_t numSlots = 4;
+    while (numSlots < count * 2) numSlots *= 2;
+
+    std::vector<std::uint32_t> offsets(count + 1, 0);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        offsets[i + 1] = offsets[i] + static_cast<std::uint32_t>(strings[i].size());
+    }
+
+    std::vector<Code> slots(numSlots, kUnknownCode);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint32_t s = fnv1a(strings[i]) & (numSlots - 1);
+        while (slots[s] != kUnknownCode) s = (s + 1) & (numSlots - 1);
+        slots[s] = static_cast<Code>(i);
+    }
+
+    writeRaw(out, &count, 1);
+    writeRaw(out, &numSlots, 1);
+    writeRaw(out, offsets.data(), offsets.size());
+    writeRaw(out, slots.data(), slots.size());
+    for (const auto& text : strings) {
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+}
+
+// Разметка строковой таблицы внутри файла с проверкой границ
+bool mapStringTable(const char* data, std::size_t size, std::size_t& pos,
+                    MappedModel::StringTable& table) {
+    pos = (pos + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+    if (pos > size || size - pos < 8) return false;
+
+    std::memcpy(&table.count, data + pos, 4);
+    std::memcpy(&table.numSlots, data + pos + 4, 4);
+    pos += 8;
+    if (table.count >= kUnknownCode || table.numSlots == 0 ||
+        (table.numSlots & (table.numSlots - 1)) != 0 || table.numSlots <= table.count) {
+        return false;
+    }
+
+    const std::size_t offsetsBytes = (std::size_t(table.count) + 1) * 4;
+    const std::size_t slotsBytes = std::size_t(table.numSlots) * sizeof(Code);
+    if (size - pos < offsetsBytes + slotsBytes) return false;
+
+    table.offsets = reinterpret_cast<const std::uint32_t*>(data + pos);
+    pos += offsetsBytes;
+    table.slots = reinterpret_cast<const Code*>(data + pos);
+    pos += slotsBytes;
+
+    const std::size_t bytes = table.offsets[table.count];
+    if (size - pos < bytes) return false;
+    table.bytes = data + pos;
+    pos += bytes;
+
+    // Строка i — [offsets[i], offsets[i + 1]) внутри bytes
+    if (table.offsets[0] != 0) return false;
+    for (std::uint32_t i = 0; i < table.count; ++i) {
+        if (table.offsets[i] > table.offsets[i + 1]) return false;
+    }
+
+    // Каждый код ровно в одной ячейке, остальные пусты: иначе find
+    // читает за границей offsets или не находит пустой ячейки и зацикливается
+    std::vector<bool> seen(table.count, false);
+    std::uint32_t filled = 0;
+    for (std::uint32_t s = 0; s < table.numSlots; ++s) {
+        const Code code = table.slots[s];
+        if (code == kUnknownCode) continue;
+        if (code >= table.count || seen[code]) return false;
+        seen[code] = true;
+        ++filled;
+    }
+    return filled == table.count;
+}
+
+// Проверка узлов перед использованием: traverseFlatTree и encodeValue
+// индексируют массивы без проверок. Узлы записаны в порядке обхода в
+// ширину, поэтому ребёнок всегда стоит дальше родителя — это заодно
+// исключает циклы в таблице детей
+bool validTree(const FlatNode* nodes, std::size_t numNodes,
+               const std::int32_t* childTable, std::size_t childTableSize,
+               std::size_t numAttrs, std::size_t numClasses) {
+    for (std::size_t i = 0; i < numNodes; ++i) {
+        const FlatNode& node = nodes[i];
+        if (node.attr < 0) {
+            if (node.attr != -1) return false;
+            if (node.offset != kNoClass && node.offset >= numClasses) return false;
+            continue;
+        }
+
+        // Порогов формат не описывает
+        if (static_cast<std::size_t>(node.attr) >= numAttrs ||
+            node.numCodes == kThresholdNode ||
+            std::size_t(node.offset) + node.numCodes > childTableSize) {
+            return false;
+        }
+        for (std::uint32_t code = 0; code < node.numCodes; ++code) {
+            const std::int32_t child = childTable[node.offset + code];
+            if (child == -1) continue;
+            if (child <= static_cast<std::int64_t>(i) ||
+                static_cast<std::size_t>(child) >= numNodes) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Code MappedModel::StringTable::find(std::string_view value) const {
+    const std::uint32_t mask = numSlots - 1;
+    for (std::uint32_t s = fnv1a(value) & mask;; s = (s + 1) & mask) {
+        const Code code = slots[s];
+        if (code == kUnknownCode || at(code) == value) return code;
+    }
+}
+
+bool saveModel(const std::string& filename,
+               const CompiledTree& tree,
+               const EncodedDataset& trainingData) {
+    namespace fs = std::filesystem;
+
+    if (!tree.thresholds.empty()) {
+        std::cerr << "Формат модели не поддерживает числовые атрибуты: " << filename << '\n';
+        return false;
+    }
+
+    fs::path path(filename);
+    fs::path dir = path.parent_path();
+    if (!dir.empty()) {
+        fs::create_directories(dir);
+    }
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << "Не удалось открыть файл для записи: " << filename << '\n';
+        return false;
+    }
+
+    ModelHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.numNodes = static_cast<std::uint32_t>(tree.nodes.size());
+    header.childTableSize = static_cast<std::uint32_t>(tree.childTable.size());
+    header.numAttrs = static_cast<std::uint32_t>(trainingData.numAttrs());
+    writeRaw(out, &header, 1); // смещения допишем в конце
+
+    // ===== УЗЛЫ =====
+    writePadding(out);
+    header.nodesOffset = static_cast<std::uint64_t>(out.tellp());
+    writeRaw(out, tree.nodes.data(), tree.nodes.size());
+
+    writePadding(out);
+    header.childTableOffset = static_cast<std::uint64_t>(out.tellp());
+    writeRaw(out, tree.childTable.data(), tree.childTable.size());
+
+    // ===== СЛОВАРИ =====
+    writePadding(out);
+    header.tablesOffset = static_cast<std::uint64_t>(out.tellp());
+    writeStringTable(out, trainingData.attrNames);
+    for (const auto& dict : trainingData.attrDicts) {
+        writeStringTable(out, dict.values);
+    }
+    writeStringTable(out, trainingData.labelDict.values);
+
+    out.seekp(0);
+    writeRaw(out, &header, 1);
+
+    if (!out) {
+        std::cerr << "Ошибка записи файла: " << filename << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool MappedModel::open(const std::string& filename) {
+    auto fail = [&](const char* what) {
+        std::cerr << what << ": " << filename << '\n';
+        file_.close();
+        return false;
+    };
+
+    if (!file_.open(filename, MappedFile::Access::Normal)) {
+        std::cerr << "Не удалось открыть файл для чтения: " << filename << '\n';
+        return false;
+    }
+
+    const char* data = file_.data();
+    const std::size_t size = file_.size();
+
+    ModelHeader header{};
+    if (size < sizeof(header)) return fail("Файл не является моделью");
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail("Файл не является моделью");
+    }
+    if (header.version != kVersion) {
+        return fail("Неподдерживаемая версия модели");
+    }
+    if (header.numNodes == 0 ||
+        header.nodesOffset > size ||
+        (size - header.nodesOffset) / sizeof(FlatNode) < header.numNodes ||
+        header.childTableOffset > size ||
+        (size - header.childTableOffset) / 4 < header.childTableSize ||
+        header.tablesOffset > size ||
+        header.nodesOffset % alignof(FlatNode) != 0 ||
+        header.childTableOffset % alignof(std::int32_t) != 0) {
+        return fail("Файл модели повреждён");
+    }
+
+    nodes_ = reinterpret_cast<const FlatNode*>(data + header.nodesOffset);
+    childTable_ = reinterpret_cast<const std::int32_t*>(data + header.childTableOffset);
+
+    std::size_t pos = static_cast<std::size_t>(header.tablesOffset);
+    attrDicts_.assign(header.numAttrs, {});
+    bool ok = mapStringTable(data, size, pos, attrNames_) &&
+              attrNames_.count == header.numAttrs;
+    for (auto& dict : attrDicts_) {
+        ok = ok && mapStringTable(data, size, pos, dict);
+    }
+    ok = ok && mapStringTable(data, size, pos, classNames_);
+    ok = ok && validTree(nodes_, header.numNodes, childTable_, header.childTableSize,
+                         attrNames_.count, classNames_.count);
+    if (!ok) return fail("Файл модели повреждён");
+
+    return true;
+}
+
+std::string_view MappedModel::className(int code) const {
+    if (code < 0 || code >= static_cast<int>(classNames_.count)) return "Неизвестно";
+    return classNames_.at(static_cast<std::size_t>(code));
+}
+
+std::string_view MappedModel::classify(const Example& example) const {
+    const int code = traverseFlatTree(nodes_, childTable_, [&](int attr) {
+        return static_cast<std::size_t>(attr) < example.attrs.size()
+                   ? encodeValue(static_cast<std::size_t>(attr), example.attrs[attr])
+                   : kUnknownCode;
+    });
+    return className(code);
+}
@@ -0,0 +1,164 @@
+#include "random_forest.h"
+
+#include <numeric>
+#include <random>
+
+namespace random_forest_detail {
+
+std::vector<std::uint32_t> bootstrapCounts(std::size_t numRows, double fraction,
+                                           std::uint64_t seed) {
+    std::vector<std::uint32_t> counts(numRows, 0);
+    if (numRows == 0) return counts;
+
+    const auto draws = static_cast<std::size_t>(
+        std::llround(static_cast<double>(numRows) * fraction));
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<std::size_t> pick(0, numRows - 1);
+    for (std::size_t i = 0; i < draws; ++i) {
+        ++counts[pick(rng)];
+    }
+    return counts;
+}
+
+ForestTree makeForestTree(const DecisionTree& tree,
+                          const EncodedDataset& data,
+                          const std::vector<std::uint32_t>& rowCounts) {
+    ForestTree result;
+    result.tree = compileTree(tree);
+    const std::size_t numClasses = data.labelDict.size();
+
+    // Листьям — подряд идущие строки таблицы долей
+    std::uint32_t numLeaves = 0;
+    result.leafSlots.assign(result.tree.nodes.size(), 0);
+    for (std::size_t i = 0; i < result.tree.nodes.size(); ++i) {
+        if (result.tree.nodes[i].attr < 0) result.leafSlots[i] = numLeaves++;
+    }
+    result.leafShares.assign(static_cast<std::size_t>(numLeaves) * numClasses, 0.0f);
+
+    // Строки выборки спускаются по дереву в те же листья, где они
+    // оказались при обучении
+    std::vector<double> counts(result.leafShares.size(), 0.0);
+    for (std::size_t row = 0; row < rowCounts.size(); ++row) {
+        if (rowCounts[row] == 0 || data.label(row) >= numClasses) continue;
+        const std::int32_t leaf = result.tree.leafIndex(data, row);
+        if (leaf < 0) continue;
+        counts[result.leafSlots[leaf] * numClasses + data.label(row)] += rowCounts[row];
+    }
+
+    for (std::size_t slot = 0; slot < numLeaves; ++slot) {
+        const double* leafCounts = counts.data() + slot * numClasses;
+        const double total = std::accumulate(leafCounts, leafCounts + numClasses, 0.0);
+        if (total == 0.0) continue;
+        for (std::size_t c = 0; c < numClasses; ++c) {
+            result.leafShares[slot * numClasses + c] = static_cast<float>(leafCounts[c] / total);
+        }
+    }
+    return result;
+}
+
+} // namespace random_forest_detail
+
+// Строк в одном блоке пакетной классификации
+static constexpr std::size_t kForestBlockRows = 256;
+
+// Голоса деревьев за строки [begin, end): scores — строки x классы.
+// Возвращает для каждой строки число деревьев, дошедших до листа
+static void collectVotes(const RandomForest& forest,
+                         const EncodedDataset& data,
+                         std::size_t begin, std::size_t end,
+                         ForestVote vote,
+                         std::vector<double>& scores,
+                         std::vector<std::uint32_t>& answered) {
+    const std::size_t numClasses = forest.numClasses();
+    scores.assign((end - begin) * numClasses, 0.0);
+    answered.assign(end - begin, 0);
+
+    for (const ForestTree& tree : forest.trees) {
+        for (std::size_t row = begin; row < end; ++row) {
+            const std::int32_t leaf = tree.tree.leafIndex(data, row);
+            if (leaf < 0) continue;
+
+            double* rowScores = scores.data() + (row - begin) * numClasses;
+            if (vote == ForestVote::Majority) {
+                const std::uint32_t classCode = tree.tree.nodes[leaf].offset;
+                if (classCode == kNoClass) continue;
+                rowScores[classCode] += 1.0;
+            } else {
+                const float* shares = tree.leafShares.data() + tree.leafSlots[leaf] * numClasses;
+                for (std::size_t c = 0; c < numClasses; ++c) rowScores[c] += shares[c];
+            }
+            ++answered[row - begin];
+        }
+    }
+}
+
+// Класс с наибольшим счётом; при равенстве — меньшая по алфавиту метка.
+// -1, если все счёты нулевые
+static std::int32_t bestClass(const RandomForest& forest, const double* scores) {
+    std::int32_t best = -1;
+    for (std::size_t c = 0; c < forest.numClasses(); ++c) {
+        if (scores[c] <= 0.0) continue;
+        if (best == -1 || scores[c] > scores[best] ||
+            (scores[c] == scores[best] && forest.classNames[c] < forest.classNames[best])) {
+            best = static_cast<std::int32_t>(c);
+        }
+    }
+    return best;
+}
+
+std::vector<double> classProbabilities(const RandomForest& forest,
+                                       const EncodedDataset& data,
+                                       std::size_t row) {
+    std::vector<double> scores;
+    std::vector<std::uint32_t> answered;
+    collectVotes(forest, data, row, row + 1, ForestVote::Probability, scores, answered);
+    if (answered[0] != 0) {
+        for (double& share : scores) share /= answered[0];
+    }
+    return scores;
+}
+
+std::string classify(const RandomForest& forest,
+                     const EncodedDataset& data,
+                     std::size_t row,
+                     ForestVote vote) {
+    std::vector<double> scores;
+    std::vector<std::uint32_t> answered;
+    collectVotes(forest, data, row, row + 1, vote, scores, answered);
+    const std::int32_t best = bestClass(forest, scores.data());
+    return best < 0 ? std::string("Неизвестно") : forest.classNames[best];
+}
+
+void classifyBatch(const RandomForest& forest,
+                   const EncodedDataset& batch,
+                   std::int32_t* out,
+                   unsigned numThreads,
+                   ForestVote vote) {
+    const std::size_t numRows = batch.numRows;
+    const std::size_t numBlocks = (numRows + kForestBlockRows - 1) / kForestBlockRows;
+
+    auto runBlock = [&](std::size_t block, std::vector<double>& scores,
+                        std::vector<std::uint32_t>& answered) {
+        const std::size_t begin = block * kForestBlockRows;
+        const std::size_t end = std::min(begin + kForestBlockRows, numRows);
+        collectVotes(forest, batch, begin, end, vote, scores, answered);
+        for (std::size_t row = begin; row < end; ++row) {
+            out[row] = bestClass(forest, scores.data() + (row - begin) * forest.numClasses());
+        }
+    };
+
+    if (numThreads == 1 || numBlocks <= 1) {
+        std::vector<double> scores;
+        std::vector<std::uint32_t> answered;
+        for (std::size_t b = 0; b < numBlocks; ++b) runBlock(b, scores, answered);
+        return;
+    }
+
+    // Каждый блок пишет только в свой диапазон out; буферы — по исполнителю
+    ThreadPool pool(numThreads);
+    std::vector<std::vector<double>> scores(pool.concurrency());
+    std::vector<std::vector<std::uint32_t>> answered(pool.concurrency());
+    pool.parallelFor(numBlocks, [&](std::size_t block, unsigned slot) {
+        runBlock(block, scores[slot], answered[slot]);
+    });
+}
@@ -0,0 +1,521 @@
+#include "split_criteria.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+void fillContingencyTable(ContingencyTable& table,
+                          const Code* column,
+                          std::size_t numValues,
+                          const Code* labels,
+                          std::size_t numClasses,
+                          const std::size_t* rows,
+                          std::size_t count) {
+    table.numValues = numValues;
+    table.numClasses = numClasses;
+    table.counts.assign((numValues + 1) * numClasses, 0);
+
+    // Единственный проход по строкам узла: одно увеличение счётчика на строку.
+    // Пропуски (kUnknownCode) попадают в дополнительную последнюю строку.
+    int* counts = table.counts.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t row = rows[i];
+        const std::size_t value = std::min<std::size_t>(column[row], numValues);
+        ++counts[value * numClasses + labels[row]];
+    }
+
+    // Маргинальные суммы — по таблице, а не по строкам
+    table.valueTotals.assign(numValues, 0);
+    table.classTotals.assign(numClasses, 0);
+    table.known = 0;
+    for (std::size_t v = 0; v <= numValues; ++v) {
+        for (std::size_t c = 0; c < numClasses; ++c) {
+            const int n = counts[v * numClasses + c];
+            table.classTotals[c] += n;
+            if (v < numValues) {
+                table.valueTotals[v] += n;
+                table.known += n;
+            }
+        }
+    }
+    table.total = static_cast<int>(count);
+}
+
+double entropyOfCounts(const int* freq, std::size_t size, double n) {
+    double h = 0.0;
+    for (std::size_t i = 0; i < size; ++i) {
+        double p = freq[i] / n;
+        if (p > 0.0) {
+            h -= p * std::log2(p);
+        }
+    }
+    return h;
+}
+
+double parentEntropy(const ContingencyTable& table) {
+    if (table.total == 0) return 0.0;
+    return entropyOfCounts(table.classTotals.data(), table.numClasses,
+                           static_cast<double>(table.total));
+}
+
+double conditionalEntropy(const ContingencyTable& table) {
+    if (table.total == 0) return 0.0;
+
+    const double n = static_cast<double>(table.total);
+    double h = 0.0;
+    for (std::size_t v = 0; v < table.numValues; ++v) {
+        if (table.valueTotals[v] == 0) continue;
+        double size = static_cast<double>(table.valueTotals[v]);
+        h += (size / n) * entropyOfCounts(&table.counts[v * table.numClasses],
+                                          table.numClasses, size);
+    }
+    return h;
+}
+
+double informationGain(const ContingencyTable& table) {
+    if (table.known == 0) return 0.0;
+    return parentEntropy(table) - conditionalEntropy(table);
+}
+
+double splitInfo(const ContingencyTable& table) {
+    if (table.total == 0) return 0.0;
+    return entropyOfCounts(table.valueTotals.data(), table.numValues,
+                           static_cast<double>(table.total));
+}
+
+double gainRatio(const ContingencyTable& table) {
+    double si = splitInfo(table);
+    if (si <= 1e-12) return 0.0;
+    return informationGain(table) / si;
+}
+
+static double giniOfCounts(const int* freq, std::size_t size, double n) {
+    double g = 1.0;
+    for (std::size_t i = 0; i < size; ++i) {
+        double p = freq[i] / n;
+        g -= p * p;
+    }
+    return g;
+}
+
+double giniGain(const ContingencyTable& table) {
+    if (table.known == 0) return 0.0;
+
+    const double n = static_cast<double>(table.total);
+    double base = giniOfCounts(table.classTotals.data(), table.numClasses, n);
+    double cond = 0.0;
+    for (std::size_t v = 0; v < table.numValues; ++v) {
+        if (table.valueTotals[v] == 0) continue;
+        double size = static_cast<double>(table.valueTotals[v]);
+        cond += (size / n) * giniOfCounts(&table.counts[v * table.numClasses],
+                                          table.numClasses, size);
+    }
+    return base - cond;
+}
+
+// Уменьшение Gini при разбиении узла на две ветки с частотами классов
+// left и right (примеры с пропуском в ветки не попадают, как в giniGain)
+static double binaryGiniGain(const ContingencyTable& table, double base,
+                             const int* left, const int* right) {
+    const std::size_t numClasses = table.numClasses;
+    double nLeft = 0.0;
+    double nRight = 0.0;
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        nLeft += left[c];
+        nRight += right[c];
+    }
+    const double n = static_cast<double>(table.total);
+    return base - (nLeft / n) * giniOfCounts(left, numClasses, nLeft)
+                - (nRight / n) * giniOfCounts(right, numClasses, nRight);
+}
+
+// До скольких значений при трёх и более классах разбиения перебираются полностью
+static constexpr std::size_t kMaxExhaustiveValues = 12;
+
+double bestBinaryGiniSplit(const ContingencyTable& table,
+                           std::vector<int>* groups) {
+    const std::size_t numClasses = table.numClasses;
+
+    std::vector<std::size_t> present;
+    for (std::size_t v = 0; v < table.numValues; ++v) {
+        if (table.valueTotals[v] > 0) present.push_back(v);
+    }
+    if (groups) groups->assign(table.numValues, -1);
+    if (present.size() < 2) return 0.0;
+
+    const double base = giniOfCounts(table.classTotals.data(), numClasses,
+                                     static_cast<double>(table.total));
+    std::vector<int> left(numClasses, 0);
+    std::vector<int> right(numClasses, 0);
+    double bestGain = 0.0;
+
+    if (numClasses > 2 && present.size() <= kMaxExhaustiveValues) {
+        // Полный перебор: последнее значение всегда справа, чтобы не
+        // считать зеркальные разбиения дважды
+        const std::size_t numMasks = std::size_t{1} << (present.size() - 1);
+        std::size_t bestMask = 0;
+        for (std::size_t mask = 1; mask < numMasks; ++mask) {
+            std::fill(left.begin(), left.end(), 0);
+            std::fill(right.begin(), right.end(), 0);
+            for (std::size_t i = 0; i < present.size(); ++i) {
+                int* side = (mask >> i & 1) ? left.data() : right.data();
+                for (std::size_t c = 0; c < numClasses; ++c) {
+                    side[c] += table.at(present[i], c);
+                }
+            }
+            const double gain = binaryGiniGain(table, base, left.data(), right.data());
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestMask = mask;
+            }
+        }
+        if (groups && bestMask != 0) {
+            for (std::size_t i = 0; i < present.size(); ++i) {
+                (*groups)[present[i]] = (bestMask >> i & 1) ? 0 : 1;
+            }
+        }
+        return bestGain;
+    }
+
+    // Порядок по доле самого частого класса узла (для двух классов —
+    // то же, что по доле любого из них); дроби сравниваются без деления
+    const std::size_t key = static_cast<std::size_t>(
+        std::max_element(table.classTotals.begin(), table.classTotals.end()) -
+        table.classTotals.begin());
+    std::stable_sort(present.begin(), present.end(),
+                     [&](std::size_t a, std::size_t b) {
+                         return static_cast<long long>(table.at(a, key)) * table.valueTotals[b] <
+                                static_cast<long long>(table.at(b, key)) * table.valueTotals[a];
+                     });
+
+    // Разрез после i-го значения: слева — префикс порядка
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        right[c] = table.classTotals[c] - table.counts[table.numValues * numClasses + c];
+    }
+    std::size_t bestCut = 0;
+    for (std::size_t i = 0; i + 1 < present.size(); ++i) {
+        for (std::size_t c = 0; c < numClasses; ++c) {
+            left[c] += table.at(present[i], c);
+            right[c] -= table.at(present[i], c);
+        }
+        const double gain = binaryGiniGain(table, base, left.data(), right.data());
+        if (gain > bestGain) {
+            bestGain = gain;
+            bestCut = i + 1;
+        }
+    }
+    if (groups && bestCut != 0) {
+        for (std::size_t i = 0; i < present.size(); ++i) {
+            (*groups)[present[i]] = i < bestCut ? 0 : 1;
+        }
+    }
+    return bestGain;
+}
+
+double chiSquare(const ContingencyTable& table) {
+    if (table.known == 0) return 0.0;
+
+    // Суммы по классам только для строк с известным значением
+    const std::size_t numClasses = table.numClasses;
+    const double total = static_cast<double>(table.known);
+    double chi2 = 0.0;
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        const int missing = table.counts[table.numValues * numClasses + c];
+        const double colSum = table.classTotals[c] - missing;
+        if (colSum <= 0.0) continue;
+        for (std::size_t v = 0; v < table.numValues; ++v) {
+            if (table.valueTotals[v] == 0) continue;
+            double expected = table.valueTotals[v] * colSum / total;
+            double diff = table.at(v, c) - expected;
+            chi2 += diff * diff / expected;
+        }
+    }
+    return chi2;
+}
+
+// ln Q(a, x) — логарифм регуляризованной верхней неполной гамма-функции:
+// ряд для малых x и цепная дробь (метод Лентца) для остальных
+static double logUpperGamma(double a, double x) {
+    if (x <= 0.0) return 0.0;
+    const double logPrefix = -x + a * std::log(x) - std::lgamma(a);
+
+    if (x < a + 1.0) {
+        double ap = a;
+        double del = 1.0 / a;
+        double sum = del;
+        for (int n = 0; n < 1000; ++n) {
+            ap += 1.0;
+            del *= x / ap;
+            sum += del;
+            if (std::fabs(del) < std::fabs(sum) * 1e-15) break;
+        }
+        const double lower = std::min(1.0, sum * std::exp(logPrefix));
+        return std::log1p(-lower);
+    }
+
+    constexpr double tiny = 1e-300;
+    double b = x + 1.0 - a;
+    double c = 1.0 / tiny;
+    double d = 1.0 / b;
+    double h = d;
+    for (int i = 1; i < 1000; ++i) {
+        const double an = -i * (i - a);
+        b += 2.0;
+        d = an * d + b;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = b + an / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        const double del = d * c;
+        h *= del;
+        if (std::fabs(del - 1.0) < 1e-15) break;
+    }
+    return logPrefix + std::log(h);
+}
+
+double chiSquareLogPValue(double chi2, double df) {
+    if (df <= 0.0) return 0.0;
+    // Частые случаи двух и трёх классов — в замкнутом виде
+    if (df == 1.0 && chi2 < 1000.0) return std::log(std::erfc(std::sqrt(chi2 / 2.0)));
+    if (df == 2.0) return -chi2 / 2.0;
+    return logUpperGamma(df / 2.0, chi2 / 2.0);
+}
+
+// ln(e^a + e^b) без переполнения
+static double logAddExp(double a, double b) {
+    if (a < b) std::swap(a, b);
+    if (b == -std::numeric_limits<double>::infinity()) return a;
+    return a + std::log1p(std::exp(b - a));
+}
+
+// ln S(n, k) — логарифм числа Стирлинга второго рода (число разбиений
+// n значений на k непустых групп). Рекуррентно за O(n·k); если это
+// слишком дорого, берётся верхняя оценка k^n / k! — поправка Бонферрони
+// от этого только строже
+static double logStirling2(std::size_t n, std::size_t k) {
+    if (k == 0 || k > n) return -std::numeric_limits<double>::infinity();
+    if (k == 1 || k == n) return 0.0;
+    if (n * k > 10000000) {
+        return n * std::log(static_cast<double>(k)) - std::lgamma(k + 1.0);
+    }
+
+    std::vector<double> row(k + 1, -std::numeric_limits<double>::infinity());
+    row[0] = 0.0; // S(0, 0) = 1
+    for (std::size_t m = 1; m <= n; ++m) {
+        for (std::size_t j = std::min(m, k); j >= 1; --j) {
+            row[j] = logAddExp(std::log(static_cast<double>(j)) + row[j], row[j - 1]);
+        }
+        row[0] = -std::numeric_limits<double>::infinity();
+    }
+    return row[k];
+}
+
+// ln p-value χ² для таблицы (группы x классы) из строк частот; классы,
+// которых нет ни в одной группе, в степени свободы не входят
+static double logPValueOfCounts(const std::vector<const int*>& rows,
+                                std::size_t numClasses) {
+    std::vector<double> rowTotals(rows.size(), 0.0);
+    std::vector<double> colTotals(numClasses, 0.0);
+    double total = 0.0;
+    for (std::size_t r = 0; r < rows.size(); ++r) {
+        for (std::size_t c = 0; c < numClasses; ++c) {
+            rowTotals[r] += rows[r][c];
+            colTotals[c] += rows[r][c];
+        }
+        total += rowTotals[r];
+    }
+
+    std::size_t presentClasses = 0;
+    double chi2 = 0.0;
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        if (colTotals[c] <= 0.0) continue;
+        ++presentClasses;
+        for (std::size_t r = 0; r < rows.size(); ++r) {
+            const double expected = rowTotals[r] * colTotals[c] / total;
+            const double diff = rows[r][c] - expected;
+            chi2 += diff * diff / expected;
+        }
+    }
+    const double df = static_cast<double>((rows.size() - 1) * (presentClasses - 1));
+    return chiSquareLogPValue(chi2, df);
+}
+
+// Статистика χ² для двух групп и её число степеней свободы — без
+// выделения памяти, это самая частая операция при объединении категорий
+static double pairChiSquare(const int* a, const int* b, std::size_t numClasses,
+                            std::size_t& df) {
+    double totalA = 0.0;
+    double totalB = 0.0;
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        totalA += a[c];
+        totalB += b[c];
+    }
+    const double total = totalA + totalB;
+
+    std::size_t presentClasses = 0;
+    double chi2 = 0.0;
+    for (std::size_t c = 0; c < numClasses; ++c) {
+        const double colTotal = a[c] + b[c];
+        if (colTotal <= 0.0) continue;
+        ++presentClasses;
+        const double expectedA = totalA * colTotal / total;
+        const double expectedB = totalB * colTotal / total;
+        chi2 += (a[c] - expectedA) * (a[c] - expectedA) / expectedA +
+                (b[c] - expectedB) * (b[c] - expectedB) / expectedB;
+    }
+    df = presentClasses - 1;
+    return chi2;
+}
+
+// Критическое значение χ² с df степенями свободы для уровня ln alpha
+// (бисекцией по chiSquareLogPValue)
+static double chiSquareCritical(double logAlpha, double df) {
+    if (df <= 0.0) return std::numeric_limits<double>::infinity();
+    double lo = 0.0;
+    double hi = df + 1.0;
+    while (chiSquareLogPValue(hi, df) > logAlpha) hi *= 2.0;
+    for (int i = 0; i < 100 && hi - lo > 1e-12 * hi; ++i) {
+        const double mid = (lo + hi) / 2.0;
+        if (chiSquareLogPValue(mid, df) > logAlpha) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+ChaidSplit chaidSplit(const ContingencyTable& table, double mergeAlpha,
+                      std::vector<int>* groups) {
+    const std::size_t numClasses = table.numClasses;
+    if (groups) groups->assign(table.numValues, -1);
+
+    // Начальные группы — значения, встретившиеся в узле
+    std::vector<std::size_t> present;
+    for (std::size_t v = 0; v < table.numValues; ++v) {
+        if (table.valueTotals[v] > 0) present.push_back(v);
+    }
+    const std::size_t numPresent = present.size();
+    if (numPresent < 2) {
+        if (groups && numPresent == 1) (*groups)[present[0]] = 0;
+        return {0.0, numPresent};
+    }
+
+    std::vector<std::vector<int>> counts(numPresent);
+    std::vector<std::size_t> owner(numPresent); // значение -> группа
+    std::vector<bool> alive(numPresent, true);
+    for (std::size_t i = 0; i < numPresent; ++i) {
+        counts[i].assign(&table.counts[present[i] * numClasses],
+                         &table.counts[present[i] * numClasses] + numClasses);
+        owner[i] = i;
+    }
+
+    // Слить можно только пару с p-value больше mergeAlpha. Сначала
+    // χ² сравнивается с критическим значением, и p-value считается лишь
+    // для похожих пар; для остальных — none
+    const double none = -std::numeric_limits<double>::infinity();
+    const double logMergeAlpha = std::log(mergeAlpha);
+    std::vector<double> critical(numClasses);
+    for (std::size_t df = 0; df < numClasses; ++df) {
+        critical[df] = chiSquareCritical(logMergeAlpha, static_cast<double>(df));
+    }
+    auto mergeLogP = [&](std::size_t i, std::size_t j) {
+        if (i > j) std::swap(i, j);
+        std::size_t df = 0;
+        const double chi2 = pairChiSquare(counts[i].data(), counts[j].data(), numClasses, df);
+        return chi2 < critical[df] ? chiSquareLogPValue(chi2, static_cast<double>(df)) : none;
+    };
+
+    // Для каждой группы — лучшая пара с ней: наибольшее p-value, при
+    // равенстве — пара с меньшими номерами. Лучшая пара всех групп —
+    // лучшая и для обеих своих групп, поэтому после слияния пересчитываются
+    // только слитая группа и группы, чьей лучшей парой была одна из слитых.
+    // Так слияния обходятся без очереди всех пар
+    std::vector<double> bestLogP(numPresent, none);
+    std::vector<std::size_t> bestOther(numPresent, numPresent);
+    auto better = [](double p1, std::size_t i1, std::size_t j1,
+                     double p2, std::size_t i2, std::size_t j2) {
+        if (p1 != p2) return p1 > p2;
+        return std::minmax(i1, j1) < std::minmax(i2, j2);
+    };
+    auto offer = [&](std::size_t i, std::size_t j, double logP) {
+        if (logP == none) return;
+        if (bestOther[i] == numPresent ||
+            better(logP, i, j, bestLogP[i], i, bestOther[i])) {
+            bestLogP[i] = logP;
+            bestOther[i] = j;
+        }
+    };
+    auto recompute = [&](std::size_t i) {
+        bestLogP[i] = none;
+        bestOther[i] = numPresent;
+        for (std::size_t k = 0; k < numPresent; ++k) {
+            if (k != i && alive[k]) offer(i, k, mergeLogP(i, k));
+        }
+    };
+    for (std::size_t i = 0; i < numPresent; ++i) {
+        for (std::size_t j = i + 1; j < numPresent; ++j) {
+            const double logP = mergeLogP(i, j);
+            offer(i, j, logP);
+            offer(j, i, logP);
+        }
+    }
+
+    std::size_t numGroups = numPresent;
+    std::vector<std::size_t> stale;
+    while (numGroups > 1) {
+        std::size_t first = numPresent;
+        for (std::size_t i = 0; i < numPresent; ++i) {
+            if (!alive[i] || bestOther[i] == numPresent) continue;
+            if (first == numPresent ||
+                better(bestLogP[i], i, bestOther[i],
+                       bestLogP[first], first, bestOther[first])) {
+                first = i;
+            }
+        }
+        if (first == numPresent) break; // все пары различаются значимо
+
+        // Группа с большим номером вливается в группу с меньшим
+        const std::size_t i = std::min(first, bestOther[first]);
+        const std::size_t j = std::max(first, bestOther[first]);
+        for (std::size_t c = 0; c < numClasses; ++c) counts[i][c] += counts[j][c];
+        alive[j] = false;
+        --numGroups;
+        for (auto& g : owner) {
+            if (g == j) g = i;
+        }
+
+        bestLogP[i] = none;
+        bestOther[i] = numPresent;
+        stale.clear();
+        for (std::size_t k = 0; k < numPresent; ++k) {
+            if (k == i || !alive[k]) continue;
+            const double logP = mergeLogP(i, k);
+            offer(i, k, logP);
+            if (bestOther[k] == i || bestOther[k] == j) {
+                stale.push_back(k);
+            } else {
+                offer(k, i, logP);
+            }
+        }
+        for (std::size_t k : stale) recompute(k);
+    }
+
+    // Номера групп — по порядку первых значений
+    std::vector<int> groupIndex(numPresent, -1);
+    std::vector<const int*> rows;
+    for (std::size_t i = 0; i < numPresent; ++i) {
+        const std::size_t g = owner[i];
+        if (groupIndex[g] == -1) {
+            groupIndex[g] = static_cast<int>(rows.size());
+            rows.push_back(counts[g].data());
+        }
+        if (groups) (*groups)[present[i]] = groupIndex[g];
+    }
+    if (numGroups < 2) return {0.0, numGroups};
+
+    const double logP = logPValueOfCounts(rows, numClasses) +
+                        logStirling2(numPresent, numGroups);
+    return {std::min(0.0, logP), numGroups};
+}
@@ -0,0 +1,202 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Какому пулу и слоту принадлежит текущий рабочий поток
+struct WorkerIdentity {
+    const void* pool = nullptr;
+    unsigned slot = 0;
+};
+
+thread_local WorkerIdentity currentWorker;
+
+// Сколько раз wait() уступает процессор, прежде чем заснуть
+constexpr unsigned kWaitSpins = 64;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Слоты 0..numThreads-2 — рабочие потоки, последний — вызывающий
+    queues_.reserve(numThreads);
+    for (unsigned slot = 0; slot < numThreads; ++slot) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    workers_.reserve(numThreads - 1);
+    for (unsigned slot = 0; slot + 1 < numThreads; ++slot) {
+        workers_.emplace_back([this, slot] { workerLoop(slot); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    sleepCv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::currentSlot() const {
+    if (currentWorker.pool == this) return currentWorker.slot;
+    return static_cast<unsigned>(workers_.size());
+}
+
+void ThreadPool::run(TaskGroup& group, std::function<void(unsigned)> task) {
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+
+    WorkQueue& queue = *queues_[currentSlot()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back({std::move(task), &group});
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++queued_;
+    }
+    sleepCv_.notify_one();
+    if (parked_.load() > 0) waitCv_.notify_one();
+}
+
+bool ThreadPool::tryPop(unsigned slot, Task& task) {
+    // Сначала своя очередь с конца...
+    {
+        WorkQueue& own = *queues_[slot];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued_;
+            return true;
+        }
+    }
+
+    // ...затем перехват из чужих очередей с начала
+    const std::size_t n = queues_.size();
+    for (std::size_t i = 1; i < n; ++i) {
+        WorkQueue& victim = *queues_[(slot + i) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::execute(Task& task, unsigned slot) {
+    // Исключение не должно уйти из рабочего потока (std::terminate):
+    // его получит тот, кто ждёт группу
+    try {
+        task.fn(slot);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(task.group->errorMutex_);
+        if (!task.group->error_) task.group->error_ = std::current_exception();
+    }
+
+    // Последняя задача группы будит уснувших в wait(). После уменьшения
+    // счётчика группа может быть уже уничтожена, поэтому будим через
+    // переменную пула, а не через саму группу
+    if (task.group->pending_.fetch_sub(1) == 1 && parked_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        waitCv_.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned slot) {
+    currentWorker = {this, slot};
+
+    Task task;
+    while (true) {
+        if (tryPop(slot, task)) {
+            execute(task, slot);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCv_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0) return;
+    }
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+    const unsigned slot = currentSlot();
+
+    Task task;
+    unsigned idleSpins = 0;
+    while (group.pending_.load(std::memory_order_acquire) > 0) {
+        if (tryPop(slot, task)) {
+            execute(task, slot);
+            idleSpins = 0;
+            continue;
+        }
+
+        // Оставшиеся задачи группы уже выполняются другими потоками.
+        // Короткие задачи дожидаемся, уступая процессор, а дальше засыпаем,
+        // пока группа не завершится или в очередях не появится работа
+        if (++idleSpins < kWaitSpins) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        ++parked_;
+        waitCv_.wait(lock, [&group, this] {
+            return group.pending_.load() == 0 || queued_ > 0;
+        });
+        --parked_;
+        idleSpins = 0;
+    }
+
+    if (group.error_) {
+        std::exception_ptr error = std::exchange(group.error_, nullptr);
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count,
+                             const std::function<void(std::size_t, unsigned)>& body) {
+    if (count == 0) return;
+
+    const unsigned slot = currentSlot();
+    const std::size_t helpers = std::min<std::size_t>(workers_.size(), count - 1);
+    if (helpers == 0) {
+        for (std::size_t i = 0; i < count; ++i) body(i, slot);
+        return;
+    }
+
+    // Итерации раздаются по одной через общий счётчик
+    std::atomic<std::size_t> next{0};
+    auto drain = [&](unsigned executor) {
+        for (std::size_t i = next++; i < count; i = next++) {
+            body(i, executor);
+        }
+    };
+
+    TaskGroup group;
+    for (std::size_t h = 0; h < helpers; ++h) {
+        run(group, drain);
+    }
+    // Помощники ссылаются на локальные переменные этой функции, поэтому
+    // их нужно дождаться и при исключении в вызывающем потоке
+    try {
+        drain(slot);
+    } catch (...) {
+        next = count;
+        try {
+            wait(group);
+        } catch (...) {
+        }
+        throw;
+    }
+    wait(group);
+}
@@ -0,0 +1,290 @@
+#include "tree_builder.h"
+
+#include <charconv>
+#include <numeric>
+#include <string>
+
+namespace tree_builder_detail {
+
+// Подсчёт частот классов: индекс — код класса
+std::vector<int> countLabels(const BuildContext& ctx, RowRange range) {
+    std::vector<int> freq(ctx.data.labelDict.size(), 0);
+    const Code* labels = ctx.data.labelCodes();
+    for (std::size_t i = range.begin; i < range.end; ++i) {
+        ++freq[labels[ctx.rows[i]]];
+    }
+    return freq;
+}
+
+// Все примеры узла одного класса
+bool isPure(const std::vector<int>& freq) {
+    int nonEmpty = 0;
+    for (int count : freq) {
+        if (count > 0) ++nonEmpty;
+    }
+    return nonEmpty <= 1;
+}
+
+// Код наиболее частого класса по частотам классов узла
+Code majorityClass(const BuildContext& ctx, const std::vector<int>& freq) {
+    const auto& names = ctx.data.labelDict.values;
+
+    // При равенстве частот берём меньший по алфавиту класс —
+    // так же, как при обходе std::map по строковым меткам
+    int best = -1;
+    for (std::size_t c = 0; c < freq.size(); ++c) {
+        if (freq[c] == 0) continue;
+        if (best == -1 || freq[c] > freq[best] ||
+            (freq[c] == freq[best] && names[c] < names[best])) {
+            best = static_cast<int>(c);
+        }
+    }
+    return best == -1 ? kUnknownCode : static_cast<Code>(best);
+}
+
+// Раскладка диапазона по веткам, уже записанным в ctx.rowGroup
+// (numGroups — строка уходит в хвост), так что каждая ветка получает
+// непрерывный поддиапазон. Упорядоченные массивы числовых атрибутов
+// раскладываются по тем же границам — с сохранением порядка внутри
+// каждой ветки.
+// Результат: поддиапазон для каждой ветки (пустой, если строк в ней нет).
+static std::vector<RowRange> partitionRows(BuildContext& ctx, RowRange range,
+                                           std::size_t numGroups) {
+    auto groupOf = [&](std::size_t row) -> std::size_t { return ctx.rowGroup[row]; };
+    const std::vector<std::size_t> offsets = groupOffsets(ctx.rows, range, numGroups, groupOf);
+
+    std::vector<RowRange> parts;
+    parts.reserve(numGroups);
+    for (std::size_t g = 0; g < numGroups; ++g) {
+        parts.push_back({offsets[g], offsets[g + 1]});
+    }
+
+    scatterRows(ctx.rows, ctx.scratch, range, offsets, groupOf);
+    for (auto& order : ctx.sorted) {
+        if (!order.empty()) scatterRows(order, ctx.scratch, range, offsets, groupOf);
+    }
+    return parts;
+}
+
+// Разбиение диапазона по веткам атрибута.
+// groups — номер ветки для каждого кода (-1 — строка не попадает ни
+// в одну ветку); пустой groups — у каждого кода своя ветка.
+// Строки без ветки и без значения атрибута отбрасываются в хвост диапазона.
+std::vector<RowRange> partitionByAttribute(BuildContext& ctx,
+                                           RowRange range,
+                                           int attrIndex,
+                                           const std::vector<int>& groups,
+                                           std::size_t numGroups) {
+    const Code* column = ctx.data.column(attrIndex);
+    for (std::size_t i = range.begin; i < range.end; ++i) {
+        const std::size_t row = ctx.rows[i];
+        const Code value = column[row];
+        std::uint32_t group = static_cast<std::uint32_t>(numGroups);
+        if (value != kUnknownCode) {
+            if (groups.empty()) {
+                group = value;
+            } else if (groups[value] >= 0) {
+                group = static_cast<std::uint32_t>(groups[value]);
+            }
+        }
+        ctx.rowGroup[row] = group;
+    }
+    return partitionRows(ctx, range, numGroups);
+}
+
+// Пропуски (NaN) не попадают ни в одну из двух веток
+std::vector<RowRange> partitionByThreshold(BuildContext& ctx,
+                                           RowRange range,
+                                           int attrIndex,
+                                           double threshold) {
+    if (ctx.data.isBinned(attrIndex)) {
+        // Порог — граница корзины: сравниваются номера корзин
+        const std::vector<double>& edges = ctx.data.binEdges[attrIndex];
+        const auto lastLeft = static_cast<std::uint8_t>(
+            std::lower_bound(edges.begin(), edges.end(), threshold) - edges.begin());
+        const std::uint8_t* bins = ctx.data.binColumn(attrIndex);
+        for (std::size_t i = range.begin; i < range.end; ++i) {
+            const std::size_t row = ctx.rows[i];
+            const std::uint8_t bin = bins[row];
+            ctx.rowGroup[row] = bin == kMissingBin ? 2 : (bin > lastLeft ? 1 : 0);
+        }
+        return partitionRows(ctx, range, 2);
+    }
+
+    const double* values = ctx.data.numberColumn(attrIndex);
+    for (std::size_t i = range.begin; i < range.end; ++i) {
+        const std::size_t row = ctx.rows[i];
+        const double value = values[row];
+        ctx.rowGroup[row] = std::isnan(value) ? 2 : (value > threshold ? 1 : 0);
+    }
+    return partitionRows(ctx, range, 2);
+}
+
+std::string_view thresholdLabel(BuildContext& ctx, bool greater, double threshold) {
+    char buffer[64];
+    const char* prefix = greater ? "> " : "<= ";
+    const std::size_t prefixSize = std::char_traits<char>::length(prefix);
+    std::copy(prefix, prefix + prefixSize, buffer);
+    const auto result = std::to_chars(buffer + prefixSize, buffer + sizeof(buffer), threshold);
+    return ctx.arena().copyString(
+        std::string_view(buffer, static_cast<std::size_t>(result.ptr - buffer)));
+}
+
+void fillHistograms(BuildContext& ctx, RowRange range, std::vector<int>& histogram) {
+    const std::size_t numClasses = ctx.data.labelDict.size();
+    const Code* labels = ctx.data.labelCodes();
+    histogram.assign(ctx.histogramSize, 0);
+
+    auto fillAttribute = [&](std::size_t k, unsigned) {
+        const int attr = ctx.histogramAttrs[k];
+        const std::uint8_t* bins = ctx.data.binColumn(attr);
+        const std::size_t missing = ctx.data.binEdges[attr].size();
+        int* hist = histogram.data() + ctx.histogramOffsets[attr];
+        for (std::size_t i = range.begin; i < range.end; ++i) {
+            const std::size_t row = ctx.rows[i];
+            const std::uint8_t bin = bins[row];
+            ++hist[(bin == kMissingBin ? missing : bin) * numClasses + labels[row]];
+        }
+    };
+
+    if (ctx.pool && ctx.histogramAttrs.size() > 1 &&
+        range.size() >= ctx.options.parallelScoringMinRows) {
+        ctx.pool->parallelFor(ctx.histogramAttrs.size(), fillAttribute);
+    } else {
+        for (std::size_t k = 0; k < ctx.histogramAttrs.size(); ++k) fillAttribute(k, 0);
+    }
+}
+
+std::vector<std::vector<int>> childHistograms(BuildContext& ctx, RowRange range,
+                                              const std::vector<RowRange>& parts,
+                                              const std::vector<int>& histogram) {
+    return subtractChildHistograms(range, parts, histogram,
+                                   [&ctx](RowRange part, std::vector<int>& out) {
+                                       fillHistograms(ctx, part, out);
+                                   });
+}
+
+// Лист с классом classCode; kUnknownCode — лист без данных
+TreeNode* makeLeaf(BuildContext& ctx, Code classCode) {
+    auto* node = ctx.arena().create<TreeNode>();
+    node->isLeaf = true;
+    node->classCode = classCode;
+    node->label = classCode == kUnknownCode ? std::string_view("Нет данных")
+                                            : ctx.labelNames[classCode];
+    return node;
+}
+
+void prepareBuild(BuildContext& ctx, Arena& arena,
+                  const std::vector<int>& availableAttributes,
+                  const std::vector<std::uint32_t>& rowCounts) {
+    const EncodedDataset& data = ctx.data;
+
+    ctx.tables.resize(ctx.pool ? ctx.pool->concurrency() : 1);
+    ctx.arenas.resize(ctx.tables.size());
+
+    // Строки с классом вне словаря (kUnknownCode у выборки, закодированной
+    // словарями другой) в обучение не входят: код класса служит индексом
+    // во всех таблицах частот
+    const std::size_t numClasses = data.labelDict.size();
+    const Code* labels = data.labelCodes();
+    if (rowCounts.empty()) {
+        ctx.rows.reserve(data.numRows);
+        for (std::size_t row = 0; row < data.numRows; ++row) {
+            if (labels[row] < numClasses) ctx.rows.push_back(row);
+        }
+    } else {
+        // Строка повторяется столько раз, сколько раз попала в выборку
+        std::size_t total = 0;
+        for (std::uint32_t count : rowCounts) total += count;
+        ctx.rows.reserve(total);
+        for (std::size_t row = 0; row < rowCounts.size(); ++row) {
+            if (labels[row] >= numClasses) continue;
+            ctx.rows.insert(ctx.rows.end(), rowCounts[row], row);
+        }
+    }
+    ctx.scratch.resize(ctx.rows.size());
+    ctx.rowGroup.resize(data.numRows);
+
+    // Атрибутам с корзинами — место в гистограмме узла
+    ctx.histogramOffsets.assign(data.numAttrs(), 0);
+    for (int attr : availableAttributes) {
+        if (!data.isBinned(attr)) continue;
+        ctx.histogramAttrs.push_back(attr);
+        ctx.histogramOffsets[attr] = ctx.histogramSize;
+        ctx.histogramSize += (data.binEdges[attr].size() + 1) * data.labelDict.size();
+    }
+
+    // Остальные числовые атрибуты упорядочиваются по значению один раз на всё
+    // построение; пропуски — в конце, равные значения — по номеру строки
+    ctx.sorted.resize(data.numAttrs());
+    std::vector<int> numeric;
+    for (int attr : availableAttributes) {
+        if (data.isNumeric(attr) && !data.isBinned(attr)) numeric.push_back(attr);
+    }
+    auto sortAttribute = [&](std::size_t k, unsigned) {
+        const double* values = data.numberColumn(numeric[k]);
+        auto& order = ctx.sorted[numeric[k]];
+        order = ctx.rows;
+        std::sort(order.begin(), order.end(), [values](std::size_t l, std::size_t r) {
+            const bool lMissing = std::isnan(values[l]);
+            const bool rMissing = std::isnan(values[r]);
+            if (lMissing != rMissing) return rMissing;
+            if (!lMissing && values[l] != values[r]) return values[l] < values[r];
+            return l < r;
+        });
+    };
+    if (ctx.pool && numeric.size() > 1) {
+        ctx.pool->parallelFor(numeric.size(), sortAttribute);
+    } else {
+        for (std::size_t k = 0; k < numeric.size(); ++k) sortAttribute(k, 0);
+    }
+
+    // Строки словарей копируются в арену дерева один раз
+    for (const auto& name : data.attrNames) {
+        ctx.attrNames.push_back(arena.copyString(name));
+    }
+    ctx.values.resize(data.numAttrs());
+    for (std::size_t a = 0; a < data.numAttrs(); ++a) {
+        for (const auto& value : data.attrDicts[a].values) {
+            ctx.values[a].push_back(arena.copyString(value));
+        }
+    }
+    for (const auto& label : data.labelDict.values) {
+        ctx.labelNames.push_back(arena.copyString(label));
+    }
+}
+
+std::uint64_t mixSeed(std::uint64_t seed, std::uint64_t value) {
+    // Финализатор splitmix64
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (value + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::vector<int> sampleAttributes(const std::vector<int>& availableAttributes,
+                                  std::size_t count, std::uint64_t seed) {
+    // Частичное перемешивание Фишера — Йетса по позициям, затем
+    // исходный порядок: при равных оценках выбор не зависит от случая
+    std::vector<std::size_t> positions(availableAttributes.size());
+    std::iota(positions.begin(), positions.end(), std::size_t{0});
+    for (std::size_t i = 0; i < count; ++i) {
+        seed = mixSeed(seed, i);
+        const std::size_t j = i + seed % (positions.size() - i);
+        std::swap(positions[i], positions[j]);
+    }
+    positions.resize(count);
+    std::sort(positions.begin(), positions.end());
+
+    std::vector<int> sampled;
+    sampled.reserve(count);
+    for (std::size_t pos : positions) sampled.push_back(availableAttributes[pos]);
+    return sampled;
+}
+
+std::unique_ptr<ThreadPool> makeBuildPool(const TreeOptions& options) {
+    if (options.numThreads == 1) return nullptr;
+    return std::make_unique<ThreadPool>(options.numThreads);
+}
+
+} // namespace tree_builder_detail
@@ -1,6 +1,8 @@
 #include "tree_utils.h"
 
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
 void printTree(const TreeNode* node,
                const std::string& prefix,
@@ -16,15 +18,28 @@ void printTree(const TreeNode* node,
         std::cout << "[АТРИБУТ: " << node->label << "]\n";
     }
 
-    // Дети
-    const std::size_t childCount = node->children.size();
-    std::size_t i = 0;
-    for (const auto& [value, child] : node->children) {
-        bool childIsLast = (++i == childCount);
+    // Дети. Ветки с общим поддеревом (CART) выводятся одной строкой
+    // со списком значений — в порядке первого значения группы
+    std::vector<const TreeNode*> children;
+    std::unordered_map<const TreeNode*, std::string> values;
+    for (std::size_t i = 0; i < node->numEdges; ++i) {
+        const TreeNode* child = node->edges[i].child;
+        auto [it, inserted] = values.try_emplace(child);
+        if (inserted) {
+            children.push_back(child);
+        } else {
+            it->second += ", ";
+        }
+        it->second += node->edges[i].value;
+    }
+
+    for (std::size_t k = 0; k < children.size(); ++k) {
+        const TreeNode* child = children[k];
+        bool childIsLast = (k + 1 == children.size());
 
         std::cout << prefix
                   << (isLast ? "    " : "│   ")
-                  << "(" << value << ") "
+                  << "(" << values[child] << ") "
                   << (childIsLast ? "" : "") ;
 
         // Чтобы ветка с подписью значения не "съедала" начало строки,